@@ -1,66 +1,193 @@
 #include "ActiveObject.hpp"
-#include <iostream>
 #include "Logger.hpp"
 
-ActiveObject::ActiveObject() : running(false), nextStage(nullptr) {
-    log("[ActiveObject] Created.");
+ActiveObject::ActiveObject(size_t capacity, OverflowPolicy policy, bool singleProducer)
+    : running(false), capacity(capacity), policy(policy) {
+    if (singleProducer) {
+        ring = std::make_unique<SpscRing<Task>>(capacity > 0 ? capacity : DEFAULT_RING_CAPACITY);
+    }
+    LOG_DEBUG("[ActiveObject] Created.");
 }
 
 ActiveObject::~ActiveObject() {
     stop();
 }
 
-void ActiveObject::start() {
-    log("[ActiveObject] Starting worker thread.");
+// Les tâches ne sont pas journalisées une à une : le thread sert toutes les requêtes du serveur.
+void ActiveObject::start(int cpu) {
+    LOG_DEBUG("[ActiveObject] Starting worker thread.");
     running = true;
     workerThread = std::thread([this]() {
-        while (running) {
-            std::function<std::string()> task;
-            {
-                std::unique_lock<std::mutex> lock(mtx);
-                cv.wait(lock, [this] { return !tasks.empty() || !running; });
-                if (!running && tasks.empty()) break;
-
-                task = std::move(tasks.front());
-                tasks.pop();
-                log("[ActiveObject] Task dequeued.");
+        if (ring) runRing();
+        else runQueue();
+    });
+    if (cpu >= 0 && !pinThread(workerThread, cpu)) {
+        LOG_WARNING("[ActiveObject] Failed to pin the worker thread to CPU ", cpu, ".");
+    }
+}
+
+void ActiveObject::runQueue() {
+    std::vector<Task> batch;
+    batch.reserve(MAX_BATCH);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return !tasks.empty() || !running; });
+            if (tasks.empty()) break; // Arrêté, et toutes les tâches acceptées ont été exécutées.
+
+            while (!tasks.empty() && batch.size() < MAX_BATCH) {
+                batch.push_back(tasks.pop());
             }
+        }
+        if (batch.size() == 1) notFull.notify_one();
+        else notFull.notify_all();
+        for (Task& task : batch) {
             if (task) {
-                std::string result = task();
-                log("[ActiveObject] Task executed. Result: " + result);
-                if (nextStage) {
-                    nextStage->enqueue([result]() -> std::string {
-                        log("[ActiveObject] Passing result to next stage.");
-                        return result;
-                    });
-                }
+                task();
             }
         }
-    });
+        batch.clear();
+    }
+}
+
+void ActiveObject::runRing() {
+    std::vector<Task> batch(MAX_BATCH);
+    for (;;) {
+        size_t count = 0;
+        while (count < MAX_BATCH && ring->try_pop(batch[count])) ++count;
+        if (count == 0) {
+            if (!running) break; // Arrêté, et l'anneau est vide.
+            ringNotEmpty.wait([this] { return !ring->empty() || !running; });
+            continue;
+        }
+        ringNotFull.notify();
+        for (size_t i = 0; i < count; ++i) {
+            if (batch[i]) {
+                batch[i]();
+            }
+            batch[i] = nullptr;
+        }
+    }
 }
 
 void ActiveObject::stop() {
-    log("[ActiveObject] Stopping worker thread.");
+    LOG_DEBUG("[ActiveObject] Stopping worker thread.");
     {
         std::lock_guard<std::mutex> lock(mtx);
         running = false;
+        stopped = true;
     }
     cv.notify_all();
+    notFull.notify_all(); // Les producteurs bloqués voient l'arrêt et abandonnent.
+    ringNotEmpty.notify_always();
+    ringNotFull.notify_always();
     if (workerThread.joinable()) {
         workerThread.join();
-        log("[ActiveObject] Worker thread stopped.");
+        LOG_DEBUG("[ActiveObject] Worker thread stopped.");
     }
 }
 
-void ActiveObject::enqueue(std::function<std::string()> task) {
+bool ActiveObject::enqueue(Task task) {
+    if (ring) return enqueueRing(task, policy == OverflowPolicy::Block);
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!makeRoom(lock)) return false;
+        push(std::move(task));
+    }
+    cv.notify_one();
+    return true;
+}
+
+size_t ActiveObject::enqueue_bulk(std::vector<Task> batch) {
+    size_t accepted = 0;
+    if (ring) {
+        // Un seul réveil du consommateur pour tout le lot.
+        bool wait = policy == OverflowPolicy::Block;
+        for (Task& task : batch) {
+            bool pushed;
+            while (!(pushed = ring->try_push(task)) && wait && !stopped) {
+                ringNotEmpty.notify(); // Le consommateur doit vider l'anneau pour que le lot avance.
+                ringNotFull.wait([this] { return ring->size() < ring->capacity() || stopped; });
+            }
+            if (!pushed) break;
+            ++accepted;
+        }
+        size_t depth = ring->size();
+        if (depth > maxDepth.load(std::memory_order_relaxed)) maxDepth.store(depth, std::memory_order_relaxed);
+        ringNotEmpty.notify();
+        return accepted;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (Task& task : batch) {
+            if (!makeRoom(lock)) break;
+            push(std::move(task));
+            ++accepted;
+        }
+    }
+    if (accepted == 1) cv.notify_one();
+    else if (accepted > 1) cv.notify_all();
+    return accepted;
+}
+
+bool ActiveObject::makeRoom(std::unique_lock<std::mutex>& lock) {
+    if (stopped) return false;
+    if (capacity == 0 || tasks.size() < capacity) return true;
+    switch (policy) {
+        case OverflowPolicy::Block:
+            cv.notify_one(); // Les tâches déjà ajoutées par un lot doivent pouvoir être consommées.
+            notFull.wait(lock, [this] { return tasks.size() < capacity || stopped; });
+            return !stopped;
+        case OverflowPolicy::Reject:
+            return false;
+        case OverflowPolicy::DropOldest:
+            tasks.pop();
+            ++droppedTasks;
+            return true;
+    }
+    return false;
+}
+
+bool ActiveObject::try_enqueue(Task task) {
+    if (ring) return enqueueRing(task, false);
     {
         std::lock_guard<std::mutex> lock(mtx);
-        tasks.push(std::move(task));
-        log("[ActiveObject] Task enqueued.");
+        if (stopped || (capacity > 0 && tasks.size() >= capacity)) return false;
+        push(std::move(task));
     }
     cv.notify_one();
+    return true;
 }
 
-void ActiveObject::setNextStage(ActiveObject* next) {
-    nextStage = next;
-}
\ No newline at end of file
+// Côté producteur de l'anneau : aucun verrou, sauf pour réveiller un consommateur endormi.
+bool ActiveObject::enqueueRing(Task& task, bool wait) {
+    if (stopped) return false;
+    while (!ring->try_push(task)) {
+        if (!wait || stopped) return false;
+        ringNotFull.wait([this] { return ring->size() < ring->capacity() || stopped; });
+    }
+    size_t depth = ring->size();
+    if (depth > maxDepth.load(std::memory_order_relaxed)) maxDepth.store(depth, std::memory_order_relaxed);
+    ringNotEmpty.notify();
+    return true;
+}
+
+void ActiveObject::push(Task task) {
+    tasks.push(std::move(task));
+    if (tasks.size() > maxDepth) maxDepth = tasks.size();
+}
+
+size_t ActiveObject::depth() {
+    if (ring) return ring->size();
+    std::lock_guard<std::mutex> lock(mtx);
+    return tasks.size();
+}
+
+size_t ActiveObject::highWaterMark() {
+    return maxDepth;
+}
+
+size_t ActiveObject::dropped() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return droppedTasks;
+}
@@ -1,39 +1,125 @@
 #ifndef ACTIVE_OBJECT_HPP
 #define ACTIVE_OBJECT_HPP
 
-#include <queue>
-#include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "SpscRing.hpp"
+#include "TaskQueue.hpp"
+#include "UniqueTask.hpp"
+#include "CpuAffinity.hpp"
 
 /**
  * @class ActiveObject
- * @brief Active Object qui exécute des tâches de manière asynchrone et transmet les résultats.
+ * @brief Active Object qui exécute, dans l'ordre, les tâches qui lui sont confiées sur son propre thread.
+ *
+ * Le thread est créé par `start` et vit jusqu'à `stop` : un même ActiveObject sert toutes les
+ * tâches qu'on lui soumet, sans création de thread par tâche.
+ *
+ * La file peut être bornée (`capacity`) ; lorsqu'elle est pleine, `enqueue` applique la politique
+ * choisie. Avec `Block`, un producteur plus rapide que l'objet est ralenti à son rythme : dans un
+ * pipeline, l'étape qui alimente une étape saturée se bloque, sa propre file se remplit, et la
+ * contre-pression remonte ainsi jusqu'au premier producteur au lieu de faire grossir les files.
+ *
+ * Lorsqu'un seul thread alimente l'objet (étape suivante d'un pipeline, par exemple), la file peut
+ * être un `SpscRing` sans verrou (`singleProducer`) : le passage d'une tâche ne coûte alors ni
+ * verrou ni appel système tant que le consommateur est actif, et les deux threads attendent avec
+ * `SpinThenPark`. Dans ce mode la file est toujours bornée, et `DropOldest` se comporte comme
+ * `Reject` (seul le consommateur peut retirer une tâche de l'anneau).
+ *
+ * Le thread retire jusqu'à `MAX_BATCH` tâches à chaque prise du verrou (ou à chaque passage sur
+ * l'anneau) puis les exécute hors verrou : quand la file est chargée, le verrou et les réveils
+ * des producteurs bloqués ne coûtent qu'une fois par lot.
  */
 class ActiveObject {
 public:
-    ActiveObject();
+    using Task = UniqueTask; ///< Tâche non copiable, sans allocation pour les petites captures.
+
+    /**
+     * @brief Comportement de `enqueue` lorsque la file est pleine.
+     */
+    enum class OverflowPolicy {
+        Block,      ///< Attendre qu'une place se libère.
+        Reject,     ///< Refuser la nouvelle tâche (`enqueue` renvoie false).
+        DropOldest  ///< Abandonner la tâche la plus ancienne de la file pour faire place à la nouvelle.
+    };
+
+    /**
+     * @param capacity Nombre maximal de tâches en attente (0 : file non bornée, ou
+     *                 `DEFAULT_RING_CAPACITY` avec `singleProducer`).
+     * @param policy Politique appliquée lorsque la file est pleine.
+     * @param singleProducer Vrai si un seul et même thread appellera `enqueue` : la file est alors
+     *                       un anneau sans verrou.
+     */
+    explicit ActiveObject(size_t capacity = 0, OverflowPolicy policy = OverflowPolicy::Block, bool singleProducer = false);
     ~ActiveObject();
 
-    void start();
+    /**
+     * @brief Crée le thread de l'objet, fixé sur le cœur `cpu` si celui-ci est positif.
+     */
+    void start(int cpu = -1);
+
+    /**
+     * @brief Refuse les nouvelles tâches, puis attend que le thread ait exécuté celles déjà acceptées.
+     */
     void stop();
-    void enqueue(std::function<std::string()> task);
 
     /**
-     * @brief Définit l'étape suivante dans le pipeline.
-     * @param next Un pointeur vers le prochain ActiveObject.
+     * @brief Ajoute une tâche à la file ; elle sera exécutée par le thread de l'objet.
+     * @return false si la tâche a été refusée (file pleine avec `Reject`, ou objet arrêté).
      */
-    void setNextStage(ActiveObject* next);
+    bool enqueue(Task task);
+
+    /**
+     * @brief Ajoute plusieurs tâches en une seule prise du verrou (et un seul réveil du thread).
+     * @return Le nombre de tâches acceptées, dans l'ordre : les suivantes ont été refusées comme
+     *         par `enqueue`.
+     */
+    size_t enqueue_bulk(std::vector<Task> batch);
+
+    /**
+     * @brief Ajoute une tâche sans jamais attendre, quelle que soit la politique.
+     * @return false si la file est pleine ou l'objet arrêté.
+     */
+    bool try_enqueue(Task task);
+
+    size_t depth();          ///< Nombre de tâches en attente.
+    size_t highWaterMark();  ///< Plus grand nombre de tâches en attente observé.
+    size_t dropped();        ///< Nombre de tâches abandonnées par `DropOldest`.
+
+    static constexpr size_t DEFAULT_RING_CAPACITY = 1024;
+    static constexpr size_t MAX_BATCH = 32; ///< Tâches retirées au plus par prise du verrou.
 
 private:
-    std::queue<std::function<std::string()>> tasks;
+    TaskQueue<Task> tasks;
     std::mutex mtx;
     std::condition_variable cv;
+    std::condition_variable notFull; ///< Réveille les producteurs bloqués lorsqu'une place se libère.
     std::thread workerThread;
     std::atomic<bool> running;
-    ActiveObject* nextStage = nullptr; ///< Étape suivante dans le pipeline.
+    std::atomic<bool> stopped{false}; ///< `stop` a été appelé : plus aucune tâche n'est acceptée.
+    size_t capacity;
+    OverflowPolicy policy;
+    std::atomic<size_t> maxDepth{0};
+    size_t droppedTasks = 0;
+
+    // File sans verrou du mode `singleProducer` (nulle sinon), et attentes de ses deux côtés.
+    std::unique_ptr<SpscRing<Task>> ring;
+    SpinThenPark ringNotEmpty;
+    SpinThenPark ringNotFull;
+
+    // Ajoute la tâche (verrou tenu) et met à jour la marque haute.
+    void push(Task task);
+    // Attend qu'une place se libère ou applique la politique (verrou tenu) ; false si la tâche est refusée.
+    bool makeRoom(std::unique_lock<std::mutex>& lock);
+
+    bool enqueueRing(Task& task, bool wait);
+    void runQueue();
+    void runRing();
 };
 
-#endif // ACTIVE_OBJECT_HPP
\ No newline at end of file
+#endif // ACTIVE_OBJECT_HPP
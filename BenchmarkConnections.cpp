@@ -0,0 +1,167 @@
+/*
+ * Connection-scaling benchmark.
+ *
+ * Starts a server in this process, opens N client connections that stay idle, then measures the
+ * round-trip time of a request sent on a sample of those connections while all the others remain
+ * open. For each N it reports the time taken to connect every client, the threads and resident
+ * memory of the process, the median and p99 latency, and how many sampled requests got no answer
+ * within REQUEST_TIMEOUT_MS (a blocking server only serves as many clients as it has threads).
+ *
+ * Usage: ./benchmark_connections [-RE|-LF|-PL] [<clients>...]     (default: -RE 1000 10000 50000)
+ *
+ * Client and server share the process, so each connection uses two descriptors: the soft
+ * RLIMIT_NOFILE is raised to the hard limit and client counts that do not fit are skipped. Clients
+ * are spread over several loopback source addresses so that more of them can connect than there
+ * are ephemeral ports. The server's own logs (std::cout) are discarded during the runs.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include "../../src/Network/Server_LF.hpp"
+#include "../../src/Network/Server_PL.hpp"
+#include "../../src/Network/Server_RE.hpp"
+
+namespace {
+
+constexpr int BASE_PORT = 9500;
+constexpr int WORKER_THREADS = 4;          // Threads of the LF pool and of the RE/PL workers.
+constexpr int SAMPLE_REQUESTS = 200;       // Connections on which a request is timed.
+constexpr int REQUEST_TIMEOUT_MS = 250;
+constexpr int CLIENTS_PER_SOURCE = 20000;  // Clients per loopback source address.
+constexpr const char* REQUEST = "autoanalyze 0\n";
+constexpr const char* REPLY = "Automatic analysis disabled";
+
+// Reads a numeric field ("Threads", "VmRSS") from /proc/self/status.
+long processStatus(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) return std::stol(line.substr(field.size() + 1));
+    }
+    return -1;
+}
+
+std::unique_ptr<Server> makeServer(const std::string& mode, int port) {
+    if (mode == "-LF") return std::make_unique<Server_LF>("127.0.0.1", port, WORKER_THREADS);
+    if (mode == "-PL") return std::make_unique<Server_PL>("127.0.0.1", port, WORKER_THREADS);
+    return std::make_unique<Server_RE>("127.0.0.1", port, WORKER_THREADS);
+}
+
+// Connects client number `index` from its loopback source address; returns -1 on failure.
+int connectClient(int index, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in source{};
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl(INADDR_LOOPBACK + 1 + index / CLIENTS_PER_SOURCE);
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&source, sizeof(source)) < 0 ||
+        connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends REQUEST and waits for REPLY; returns the latency in microseconds, or -1 on timeout.
+double roundTrip(int fd) {
+    char buffer[4096];
+    while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {} // Drops the help menu.
+
+    auto begin = std::chrono::steady_clock::now();
+    if (send(fd, REQUEST, std::strlen(REQUEST), MSG_NOSIGNAL) < 0) return -1;
+    std::string reply;
+    while (reply.find(REPLY) == std::string::npos || reply.back() != '\n') {
+        int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+        pollfd ready{fd, POLLIN, 0};
+        if (elapsed >= REQUEST_TIMEOUT_MS || poll(&ready, 1, REQUEST_TIMEOUT_MS - elapsed) <= 0) return -1;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return -1;
+        reply.append(buffer, static_cast<size_t>(n));
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void run(const std::string& mode, int clients, int port) {
+    std::unique_ptr<Server> server = makeServer(mode, port);
+    std::thread loop([&server]() { server->start(); });
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<int> sockets;
+    sockets.reserve(clients);
+    for (int i = 0; i < clients; ++i) {
+        int fd = connectClient(i, port);
+        if (fd < 0) break;
+        sockets.push_back(fd);
+    }
+    double connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Lets the server accept the backlog.
+    long threads = processStatus("Threads");
+    long rssKiB = processStatus("VmRSS");
+
+    std::vector<double> latencies;
+    int timeouts = 0;
+    int samples = std::min<int>(SAMPLE_REQUESTS, static_cast<int>(sockets.size()));
+    for (int i = 0; i < samples; ++i) {
+        double latency = roundTrip(sockets[static_cast<size_t>(i) * sockets.size() / samples]);
+        if (latency < 0) ++timeouts;
+        else latencies.push_back(latency);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies.empty() ? 0.0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+
+    std::printf("%-4s %8d %8zu %10.3f %8ld %10ld %10.1f %10.1f %9d/%d\n", mode.c_str() + 1, clients,
+                sockets.size(), connectSeconds, threads, rssKiB, percentile(0.5), percentile(0.99), timeouts, samples);
+    std::fflush(stdout);
+
+    for (int fd : sockets) close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Lets blocked handlers see the hangups.
+    server->stop();
+    loop.join();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string mode = "-RE";
+    std::vector<int> counts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-RE" || arg == "-LF" || arg == "-PL") mode = arg;
+        else counts.push_back(std::stoi(arg));
+    }
+    if (counts.empty()) counts = {1000, 10000, 50000};
+
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::cout.setstate(std::ios::badbit); // Server logs.
+    std::printf("%-4s %8s %8s %10s %8s %10s %10s %10s %11s\n", "mode", "clients", "open", "connect_s",
+                "threads", "rss_KiB", "p50_us", "p99_us", "timeouts");
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (2 * static_cast<rlim_t>(counts[i]) + 64 > limit.rlim_cur) {
+            std::printf("%-4s %8d skipped: needs %d descriptors, limit is %lu\n", mode.c_str() + 1, counts[i],
+                        2 * counts[i] + 64, static_cast<unsigned long>(limit.rlim_cur));
+            continue;
+        }
+        run(mode, counts[i], BASE_PORT + static_cast<int>(i));
+    }
+    return 0;
+}
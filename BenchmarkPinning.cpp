@@ -0,0 +1,175 @@
+/*
+ * CPU pinning benchmark.
+ *
+ * Starts a server in this process twice, once with free-floating threads and once with every
+ * server thread pinned (CpuPlacement::topologyDefault(), as with `./server ... --pin`), and compares
+ * the request latency. CLIENTS client threads each build their own graph, then repeatedly change
+ * one edge and request an analysis, so every request recomputes the MST and its metrics: the work
+ * whose caches are lost when the scheduler migrates a thread. For each run it reports the median,
+ * p99 and p99.9 latency and the request rate.
+ *
+ * Usage: ./benchmark_pinning [-PL|-LF|-RE] [<requests per client>]     (default: -PL 500)
+ *
+ * Pinning only matters with several cores and a loaded machine: on a single CPU both runs share the
+ * same core and the numbers mostly measure noise.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <poll.h>
+#include "../../src/Network/CpuAffinity.hpp"
+#include "../../src/Network/Server_LF.hpp"
+#include "../../src/Network/Server_PL.hpp"
+#include "../../src/Network/Server_RE.hpp"
+
+namespace {
+
+constexpr int BASE_PORT = 9600;
+constexpr int WORKER_THREADS = 4;     // Threads of the LF pool and of the RE/PL workers.
+constexpr int CLIENTS = 4;            // Concurrent clients, one thread each.
+constexpr int VERTICES = 200;
+constexpr int EDGES = 2000;           // Random edges per client graph (plus a spanning path).
+constexpr int REQUEST_TIMEOUT_MS = 5000;
+// Ends every request: its reply marks the end of the previous commands' replies.
+constexpr const char* SENTINEL = "autoanalyze 0\n";
+constexpr const char* SENTINEL_REPLY = "Automatic analysis disabled";
+
+std::unique_ptr<Server> makeServer(const std::string& mode, int port, const CpuPlacement& placement) {
+    if (mode == "-LF") return std::make_unique<Server_LF>("127.0.0.1", port, WORKER_THREADS, placement);
+    if (mode == "-RE") {
+        return std::make_unique<Server_RE>("127.0.0.1", port, WORKER_THREADS, Server_RE::DEFAULT_MAX_CLIENTS, placement);
+    }
+    return std::make_unique<Server_PL>("127.0.0.1", port, WORKER_THREADS, placement);
+}
+
+int connectClient(int port) {
+    for (int attempt = 0; attempt < 50; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in server{};
+        server.sin_family = AF_INET;
+        server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        server.sin_port = htons(port);
+        if (connect(fd, (struct sockaddr*)&server, sizeof(server)) == 0) return fd;
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // The server is still starting.
+    }
+    return -1;
+}
+
+// Sends `commands` followed by the sentinel and reads until the sentinel's reply; false on timeout.
+bool request(int fd, const std::string& commands) {
+    std::string message = commands + SENTINEL;
+    if (send(fd, message.data(), message.size(), MSG_NOSIGNAL) < 0) return false;
+    std::string reply;
+    char buffer[16384];
+    auto begin = std::chrono::steady_clock::now();
+    while (reply.find(SENTINEL_REPLY) == std::string::npos || reply.back() != '\n') {
+        int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+        pollfd ready{fd, POLLIN, 0};
+        if (elapsed >= REQUEST_TIMEOUT_MS || poll(&ready, 1, REQUEST_TIMEOUT_MS - elapsed) <= 0) return false;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return false;
+        reply.append(buffer, static_cast<size_t>(n));
+        if (reply.size() > 2 * sizeof(buffer)) reply.erase(0, reply.size() - sizeof(buffer)); // Keeps the tail.
+    }
+    return true;
+}
+
+// One client: builds its graph, then times `requests` change-and-analyze round trips.
+void client(int port, int id, int requests, std::vector<double>& latencies, int& failures) {
+    int fd = connectClient(port);
+    if (fd < 0) {
+        failures += requests;
+        return;
+    }
+    std::mt19937 random(static_cast<unsigned>(id));
+    std::uniform_int_distribution<int> vertex(0, VERTICES - 1), weight(1, 1000);
+    std::string setup = "create " + std::to_string(VERTICES) + "\n";
+    for (int v = 1; v < VERTICES; ++v) setup += "add " + std::to_string(v - 1) + " " + std::to_string(v) + " 1000\n";
+    for (int e = 0; e < EDGES; ++e) {
+        setup += "add " + std::to_string(vertex(random)) + " " + std::to_string(vertex(random)) + " " +
+                 std::to_string(weight(random)) + "\n";
+    }
+    // Automatic analysis off first, so that only the timed requests analyze the graph.
+    if (!request(fd, "") || !request(fd, setup)) {
+        failures += requests;
+        close(fd);
+        return;
+    }
+
+    for (int i = 0; i < requests; ++i) {
+        // Re-weights an edge of the path, so the cached MST and metrics are invalidated.
+        int u = vertex(random) % (VERTICES - 1);
+        std::string commands = "remove " + std::to_string(u) + " " + std::to_string(u + 1) + "\n" + "add " +
+                               std::to_string(u) + " " + std::to_string(u + 1) + " " + std::to_string(weight(random)) +
+                               "\nanalyze weight average depth maxedge\n";
+        auto begin = std::chrono::steady_clock::now();
+        if (!request(fd, commands)) {
+            ++failures;
+            continue;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    }
+    close(fd);
+}
+
+void run(const std::string& mode, const char* name, const CpuPlacement& placement, int requests, int port) {
+    std::unique_ptr<Server> server = makeServer(mode, port, placement);
+    std::thread loop([&server]() { server->start(); });
+
+    std::vector<std::vector<double>> latencies(CLIENTS);
+    std::vector<int> failures(CLIENTS, 0);
+    std::vector<std::thread> clients;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < CLIENTS; ++i) {
+        clients.emplace_back(client, port, i, requests, std::ref(latencies[i]), std::ref(failures[i]));
+    }
+    for (auto& thread : clients) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<double> all;
+    int failed = 0;
+    for (int i = 0; i < CLIENTS; ++i) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        failed += failures[i];
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) { return all.empty() ? 0.0 : all[static_cast<size_t>(p * (all.size() - 1))]; };
+
+    std::printf("%-4s %-9s %8zu %10.1f %10.1f %10.1f %10.1f %8d\n", mode.c_str() + 1, name, all.size(),
+                percentile(0.5), percentile(0.99), percentile(0.999), seconds > 0 ? all.size() / seconds : 0.0, failed);
+    std::fflush(stdout);
+
+    server->stop();
+    loop.join();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string mode = "-PL";
+    int requests = 500;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-RE" || arg == "-LF" || arg == "-PL") mode = arg;
+        else requests = std::stoi(arg);
+    }
+
+    setLogLevel(LogLevel::Warning); // Server lifecycle logs.
+    CpuPlacement pinned = CpuPlacement::topologyDefault();
+    std::printf("clients=%d workers=%d cpus=%s (topology order)\n", CLIENTS, WORKER_THREADS,
+                formatCpuList(pinned.cpus()).c_str());
+    std::printf("%-4s %-9s %8s %10s %10s %10s %10s %8s\n", "mode", "threads", "requests", "p50_us", "p99_us",
+                "p99.9_us", "req/s", "failed");
+    run(mode, "unpinned", CpuPlacement(), requests, BASE_PORT);
+    run(mode, "pinned", pinned, requests, BASE_PORT + 1);
+    return 0;
+}
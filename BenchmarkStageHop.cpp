@@ -0,0 +1,101 @@
+/*
+ * Stage-hop microbenchmark.
+ *
+ * Chains HOPS ActiveObjects the way the pipeline does (each task enqueues the next hop on the next
+ * stage) and compares the shared mutex/condition-variable queue with the lock-free SPSC ring used
+ * between single-producer stages. Both queues are bounded at QUEUE_CAPACITY with the Block policy.
+ *
+ * - throughput: MESSAGES tasks are pushed back to back; reports the amortized time per hop.
+ * - latency: one message at a time goes through the whole chain; reports the p50/p99 time per hop.
+ *
+ * Usage: ./benchmark_stage_hop [<messages>]     (default: 1000000)
+ *
+ * Spinning only pays off when producer and consumer run on different cores: with a single CPU
+ * the ring's waits fall back to yield/park, and the numbers mostly measure the scheduler.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/Network/ActiveObject.hpp"
+
+namespace {
+
+constexpr size_t HOPS = 4;
+constexpr size_t QUEUE_CAPACITY = 1024;
+constexpr int LATENCY_SAMPLES = 20000;
+
+// HOPS stages; the producer of each stage is the previous stage (the main thread for the first).
+class Chain {
+public:
+    explicit Chain(bool ring) {
+        for (size_t i = 0; i < HOPS; ++i) {
+            stages.push_back(std::make_unique<ActiveObject>(QUEUE_CAPACITY, ActiveObject::OverflowPolicy::Block, ring));
+            stages.back()->start();
+        }
+    }
+
+    void send(size_t hop = 0) {
+        if (hop == stages.size()) {
+            delivered.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        stages[hop]->enqueue([this, hop]() { send(hop + 1); });
+    }
+
+    void waitFor(long count) {
+        while (delivered.load(std::memory_order_acquire) < count) std::this_thread::yield();
+    }
+
+    long count() { return delivered.load(std::memory_order_acquire); }
+
+private:
+    std::vector<std::unique_ptr<ActiveObject>> stages;
+    std::atomic<long> delivered{0};
+};
+
+void run(const char* name, bool ring, long messages) {
+    double throughputNs;
+    {
+        Chain chain(ring);
+        auto begin = std::chrono::steady_clock::now();
+        for (long i = 0; i < messages; ++i) chain.send();
+        chain.waitFor(messages);
+        throughputNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() /
+                       (static_cast<double>(messages) * HOPS);
+    }
+
+    std::vector<double> latencies;
+    {
+        Chain chain(ring);
+        for (int i = 0; i < LATENCY_SAMPLES; ++i) {
+            long target = chain.count() + 1;
+            auto begin = std::chrono::steady_clock::now();
+            chain.send();
+            chain.waitFor(target);
+            latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / HOPS);
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("%-6s %10ld %16.1f %14.1f %14.1f\n", name, messages, throughputNs,
+                latencies[latencies.size() / 2], latencies[static_cast<size_t>(0.99 * (latencies.size() - 1))]);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long messages = argc > 1 ? std::stol(argv[1]) : 1000000;
+    std::cout.setstate(std::ios::badbit); // ActiveObject lifecycle logs.
+    std::printf("hops=%zu capacity=%zu cpus=%u\n", HOPS, QUEUE_CAPACITY, std::thread::hardware_concurrency());
+    std::printf("%-6s %10s %16s %14s %14s\n", "queue", "messages", "ns/hop (burst)", "p50 ns/hop", "p99 ns/hop");
+    run("mutex", false, messages);
+    run("spsc", true, messages);
+    return 0;
+}
@@ -0,0 +1,16 @@
+#include "Cancellation.hpp"
+
+bool CancellationToken::deadlineExceeded() const {
+    Clock::rep deadline = _deadline.load(std::memory_order_relaxed);
+    return deadline != NO_DEADLINE && Clock::now().time_since_epoch().count() >= deadline;
+}
+
+void CancellationToken::throwIfCancelled() const {
+    if (isCancelled()) throw OperationCancelled();
+    if (deadlineExceeded()) throw DeadlineExceeded();
+}
+
+void CancellationCheckpoint::poll(size_t done, size_t total) {
+    if (total > 0) _token->setProgress(done < total ? static_cast<double>(done) / static_cast<double>(total) : 1.0);
+    _token->throwIfCancelled();
+}
@@ -0,0 +1,98 @@
+#ifndef CANCELLATION_HPP
+#define CANCELLATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+/*
+ * Cooperative cancellation of long computations (MST solves and analyses).
+ *
+ * Whoever requested the work keeps a CancellationToken and may call `cancel` from any thread. The
+ * solvers poll the token at checkpoints in their main loops and stop by throwing OperationCancelled,
+ * or DeadlineExceeded once the token's deadline has passed; `Graph::Solve` then leaves the graph and
+ * its previous MST unchanged. The solvers also report their progress through the token, so that a
+ * background job can be polled while it runs.
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled") {}
+
+protected:
+    explicit OperationCancelled(const char* reason) : std::runtime_error(reason) {}
+};
+
+class DeadlineExceeded : public OperationCancelled {
+public:
+    DeadlineExceeded() : OperationCancelled("Deadline exceeded") {}
+};
+
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+    // A child token is also cancelled when its parent is (the parent's deadline does not apply).
+    explicit CancellationToken(std::shared_ptr<const CancellationToken> parent) : _parent(std::move(parent)) {}
+
+    // Requests cancellation: the computation stops at its next checkpoint.
+    void cancel() { _cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const {
+        return _cancelled.load(std::memory_order_relaxed) || (_parent && _parent->isCancelled());
+    }
+
+    // Stops the computation at the first checkpoint after `deadline` (replaces any previous deadline).
+    void setDeadline(Clock::time_point deadline) {
+        _deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+    void clearDeadline() { _deadline.store(NO_DEADLINE, std::memory_order_relaxed); }
+    bool deadlineExceeded() const;
+
+    // Throws OperationCancelled if cancellation was requested, DeadlineExceeded if the deadline passed.
+    void throwIfCancelled() const;
+
+    // Fraction of the current computation done, in [0, 1] (updated at the checkpoints).
+    void setProgress(double fraction) { _progress.store(fraction, std::memory_order_relaxed); }
+    double progress() const { return _progress.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr Clock::rep NO_DEADLINE = Clock::duration::max().count();
+
+    std::shared_ptr<const CancellationToken> _parent;
+    std::atomic<bool> _cancelled{false};
+    std::atomic<Clock::rep> _deadline{NO_DEADLINE}; // Clock ticks since the clock's epoch.
+    std::atomic<double> _progress{0.0};
+};
+
+/*
+ * CancellationCheckpoint:
+ * Placed in a solver loop. Polls the token (if there is one) every CHECK_INTERVAL steps, so that a
+ * tight loop only pays a counter increment per step (and reads the clock for the deadline only at
+ * the polls), and records the progress as `done` / `total`.
+ */
+class CancellationCheckpoint {
+public:
+    static constexpr unsigned CHECK_INTERVAL = 1024;
+
+    explicit CancellationCheckpoint(CancellationToken* token) : _token(token) {}
+
+    void step(size_t done, size_t total) {
+        if (_token && ++_steps % CHECK_INTERVAL == 0) poll(done, total);
+    }
+
+    // Polls right away: around a long call that has no checkpoint of its own (a sort, for instance).
+    void check(size_t done, size_t total) {
+        if (_token) poll(done, total);
+    }
+
+private:
+    CancellationToken* _token;
+    unsigned _steps = 0;
+
+    // Records the progress, then throws if cancellation was requested or the deadline has passed.
+    void poll(size_t done, size_t total);
+};
+
+#endif // CANCELLATION_HPP
@@ -0,0 +1,121 @@
+#ifndef CHASE_LEV_DEQUE_HPP
+#define CHASE_LEV_DEQUE_HPP
+
+#include <atomic>   // Pour les indices et les cases partagés avec les voleurs
+#include <cstdint>  // Pour int64_t
+#include <memory>   // Pour std::unique_ptr
+#include <vector>   // Pour les tableaux remplacés, conservés jusqu'à la destruction
+
+/**
+ * @class ChaseLevDeque
+ * @brief File double sans verrou de Chase et Lev (version C11 de Lê et al., 2013).
+ *
+ * Le propriétaire (un seul thread) empile et dépile en LIFO par le bas (`push`, `pop`) sans
+ * opération atomique coûteuse, sauf lorsqu'il reste un seul élément ; les autres threads volent en
+ * FIFO par le haut (`steal`) avec un compare-and-swap. Le tableau double lorsqu'il est plein ; les
+ * anciens tableaux sont gardés jusqu'à la destruction, car un voleur peut encore y lire.
+ *
+ * @tparam T Type trivialement copiable (en pratique un pointeur).
+ */
+template <typename T>
+class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(size_t capacity = 64) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        _arrays.push_back(std::make_unique<Array>(size));
+        _array.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    /**
+     * @brief Ajoute un élément en bas (propriétaire uniquement).
+     */
+    void push(T item) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        Array* array = _array.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(array->mask)) array = grow(array, top, bottom);
+        array->put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Retire l'élément le plus récent (propriétaire uniquement).
+     * @return false si la file est vide (ou si un voleur a pris le dernier élément).
+     */
+    bool pop(T& item) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = _array.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) { // Vide.
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = array->get(bottom);
+        if (top == bottom) { // Dernier élément : course possible avec un voleur.
+            bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Vole l'élément le plus ancien (n'importe quel thread).
+     * @return false si la file est vide ou si le vol a perdu une course (il peut être retenté).
+     */
+    bool steal(T& item) {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+        if (top >= bottom) return false;
+
+        Array* array = _array.load(std::memory_order_acquire);
+        item = array->get(top);
+        return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Indique si la file est vide (approximatif si d'autres threads travaillent en même temps).
+    bool empty() const {
+        return _top.load(std::memory_order_acquire) >= _bottom.load(std::memory_order_acquire);
+    }
+
+    // Nombre d'éléments (approximatif si d'autres threads travaillent en même temps).
+    size_t size() const {
+        int64_t count = _bottom.load(std::memory_order_acquire) - _top.load(std::memory_order_acquire);
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+
+private:
+    struct Array {
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(size_t size) : mask(size - 1), slots(new std::atomic<T>[size]) {}
+        T get(int64_t index) const { return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed); }
+        void put(int64_t index, T item) { slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> _top{0};     // Prochain élément à voler
+    alignas(64) std::atomic<int64_t> _bottom{0};  // Prochaine case libre du propriétaire
+    std::atomic<Array*> _array{nullptr};
+    std::vector<std::unique_ptr<Array>> _arrays; // Tableau courant et tableaux remplacés (propriétaire)
+
+    Array* grow(Array* array, int64_t top, int64_t bottom) {
+        auto bigger = std::make_unique<Array>(2 * (array->mask + 1));
+        for (int64_t i = top; i < bottom; ++i) bigger->put(i, array->get(i));
+        Array* raw = bigger.get();
+        _arrays.push_back(std::move(bigger));
+        _array.store(raw, std::memory_order_release);
+        return raw;
+    }
+};
+
+#endif // CHASE_LEV_DEQUE_HPP
@@ -0,0 +1,110 @@
+#include "CpuAffinity.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+// Lit un entier dans un fichier de /sys (-1 s'il est absent).
+int readTopology(int cpu, const char* field) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + field);
+    int value = -1;
+    if (!(file >> value)) return -1;
+    return value;
+}
+
+bool pin(pthread_t thread, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+} // namespace
+
+CpuSet parseCpuList(const std::string& list) {
+    CpuSet cpus;
+    size_t position = 0;
+    while (position < list.size()) {
+        size_t end = list.find(',', position);
+        if (end == std::string::npos) end = list.size();
+        std::string range = list.substr(position, end - position);
+        position = end + 1;
+
+        size_t dash = range.find('-');
+        try {
+            size_t used = 0;
+            int first = std::stoi(range.substr(0, dash), &used);
+            if (used != (dash == std::string::npos ? range.size() : dash)) throw std::invalid_argument(range);
+            int last = first;
+            if (dash != std::string::npos) {
+                std::string tail = range.substr(dash + 1);
+                last = std::stoi(tail, &used);
+                if (used != tail.size()) throw std::invalid_argument(range);
+            }
+            if (first < 0 || last < first || last >= CPU_SETSIZE) throw std::invalid_argument(range);
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid CPU list '" + list + "' (expected e.g. 0-3,6).");
+        }
+    }
+    if (cpus.empty()) throw std::invalid_argument("Invalid CPU list '" + list + "' (expected e.g. 0-3,6).");
+    return cpus;
+}
+
+CpuSet allowedCpus() {
+    CpuSet cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+CpuSet topologyOrder(const CpuSet& cpus) {
+    // (rang parmi les jumeaux du cœur physique, socket, cœur physique, processeur logique)
+    std::vector<std::tuple<int, int, int, int>> order;
+    std::vector<std::pair<int, int>> seen; // (socket, cœur) de chaque processeur déjà classé
+    for (int cpu : cpus) {
+        int package = readTopology(cpu, "physical_package_id");
+        int core = readTopology(cpu, "core_id");
+        if (core < 0) core = cpu; // Topologie inconnue : chaque processeur logique est un cœur.
+        int rank = static_cast<int>(std::count(seen.begin(), seen.end(), std::make_pair(package, core)));
+        seen.emplace_back(package, core);
+        order.emplace_back(rank, package, core, cpu);
+    }
+    std::sort(order.begin(), order.end());
+
+    CpuSet sorted;
+    for (const auto& entry : order) sorted.push_back(std::get<3>(entry));
+    return sorted;
+}
+
+bool pinCurrentThread(int cpu) {
+    return pin(pthread_self(), cpu);
+}
+
+bool pinThread(std::thread& thread, int cpu) {
+    return pin(thread.native_handle(), cpu);
+}
+
+std::string formatCpuList(const CpuSet& cpus) {
+    std::string text;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (i > 0) text += ',';
+        text += std::to_string(cpus[i]);
+    }
+    return text;
+}
@@ -0,0 +1,102 @@
+#ifndef CPU_AFFINITY_HPP
+#define CPU_AFFINITY_HPP
+
+#include <cstddef>  // Pour size_t
+#include <string>   // Pour les listes de cœurs au format "0-3,6"
+#include <thread>   // Pour std::thread
+#include <utility>  // Pour std::move
+#include <vector>   // Pour les ensembles de cœurs
+
+/**
+ * Placement des threads sur les cœurs.
+ *
+ * Sans placement, l'ordonnanceur déplace librement les threads d'un cœur à l'autre, et chaque
+ * migration vide les caches L1/L2 qu'un calcul de MST venait de remplir. Un `CpuPlacement` distribue
+ * des cœurs, dans l'ordre, aux threads que le serveur crée (threads du pool, boucle d'événements,
+ * étapes du pipeline) : chacun reste sur son cœur, et avec assez de cœurs chaque étape du pipeline
+ * a le sien.
+ */
+
+using CpuSet = std::vector<int>;
+
+/**
+ * @brief Lit une liste de cœurs au format de `taskset -c` (par exemple "0-3,6").
+ * @throws std::invalid_argument si la liste est mal formée ou vide.
+ */
+CpuSet parseCpuList(const std::string& list);
+
+/**
+ * @brief Cœurs sur lesquels le processus a le droit de s'exécuter.
+ */
+CpuSet allowedCpus();
+
+/**
+ * @brief Ordonne `cpus` selon la topologie : d'abord un processeur logique par cœur physique,
+ * socket par socket, puis les processeurs jumeaux (hyperthreading).
+ *
+ * Des threads placés dans cet ordre n'ont pas à se partager un cœur physique tant qu'il en reste
+ * de libres, et des threads voisins (étapes successives du pipeline) partagent le même cache L3.
+ */
+CpuSet topologyOrder(const CpuSet& cpus);
+
+/**
+ * @brief Fixe le thread appelant sur le cœur `cpu`.
+ * @return false si le système refuse (cœur absent ou interdit au processus).
+ */
+bool pinCurrentThread(int cpu);
+
+/**
+ * @brief Fixe `thread` sur le cœur `cpu`.
+ */
+bool pinThread(std::thread& thread, int cpu);
+
+/**
+ * @brief Texte d'un ensemble de cœurs ("0,1,2"), pour les journaux.
+ */
+std::string formatCpuList(const CpuSet& cpus);
+
+/**
+ * @class CpuPlacement
+ * @brief Distribue des cœurs, à tour de rôle, aux threads qui en demandent.
+ *
+ * Un placement vide (par défaut) est désactivé : `next` renvoie -1 et `take` un ensemble vide, et
+ * les threads ne sont pas fixés. Lorsque les threads sont plus nombreux que les cœurs, la
+ * distribution reprend au premier cœur.
+ */
+class CpuPlacement {
+public:
+    CpuPlacement() = default;
+    explicit CpuPlacement(CpuSet cpus) : _cpus(std::move(cpus)) {}
+
+    /**
+     * @brief Placement par défaut : les cœurs autorisés, dans l'ordre de la topologie.
+     */
+    static CpuPlacement topologyDefault() { return CpuPlacement(topologyOrder(allowedCpus())); }
+
+    bool enabled() const { return !_cpus.empty(); }
+    const CpuSet& cpus() const { return _cpus; }
+
+    /**
+     * @brief Cœur du prochain thread (-1 si le placement est désactivé).
+     */
+    int next() {
+        if (_cpus.empty()) return -1;
+        return _cpus[_next++ % _cpus.size()];
+    }
+
+    /**
+     * @brief Cœurs des `count` prochains threads (vide si le placement est désactivé).
+     */
+    CpuSet take(size_t count) {
+        CpuSet cpus;
+        if (_cpus.empty()) return cpus;
+        for (size_t i = 0; i < count; ++i) cpus.push_back(next());
+        return cpus;
+    }
+
+private:
+    CpuSet _cpus;      // Cœurs distribués, dans l'ordre
+    size_t _next = 0;  // Indice du prochain cœur à distribuer
+};
+
+#endif // CPU_AFFINITY_HPP
@@ -0,0 +1,144 @@
+#ifndef FAIR_QUEUE_HPP
+#define FAIR_QUEUE_HPP
+
+#include <algorithm>      // Pour std::min
+#include <cstddef>        // Pour size_t
+#include <cstdint>        // Pour les coûts
+#include <unordered_map>  // Pour la sous-file de chaque client
+#include <utility>        // Pour std::move
+#include "TaskQueue.hpp"  // Sous-files et ronde des clients, sans allocation en régime établi
+
+/**
+ * @class FairQueue
+ * @brief File équitable entre clients, servie à tour de rôle par déficit (Deficit Round Robin).
+ *
+ * Chaque client a sa sous-file, et les clients qui ont des éléments en attente forment une ronde.
+ * Chaque élément porte un coût estimé (voir `Session::nextCommandCost`) : à son tour, un client
+ * reçoit `quantum` unités de crédit et n'est servi que si son crédit couvre le coût de son prochain
+ * élément ; sinon il garde son crédit pour le tour suivant. Un client qui soumet en masse de lourdes
+ * analyses n'obtient donc que sa part des threads, et les commandes courtes des autres clients
+ * passent entre ses calculs de MST au lieu d'attendre derrière eux.
+ *
+ * Un client qui n'a plus rien en attente sort de la ronde et perd son crédit. Non synchronisée :
+ * elle est protégée par le verrou de son propriétaire.
+ */
+template <typename Key, typename T>
+class FairQueue {
+public:
+    /// Crédit par tour, dans l'unité des coûts (environ un sommet ou une arête traités).
+    static constexpr uint64_t DEFAULT_QUANTUM = 4096;
+
+    explicit FairQueue(uint64_t quantum = DEFAULT_QUANTUM) : _quantum(quantum > 0 ? quantum : 1) {}
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    /**
+     * @brief Ajoute `item`, de coût estimé `cost`, à la sous-file de `client`.
+     */
+    void push(const Key& client, T item, uint64_t cost) {
+        Flow& flow = _flows.try_emplace(client).first->second;
+        flow.items.push(Item{std::move(item), cost > 0 ? cost : 1});
+        if (!flow.active) {
+            flow.active = true;
+            _ring.push(client);
+        }
+        ++_size;
+    }
+
+    /**
+     * @brief Retire l'élément du client dont c'est le tour ; la file ne doit pas être vide.
+     */
+    T pop() {
+        size_t unpaid = 0; // Clients passés depuis le dernier élément servi
+        for (;;) {
+            Flow& flow = _flows.find(_ring.front())->second;
+            if (!_in_turn) {
+                flow.deficit += _quantum;
+                _in_turn = true;
+            }
+            Item& head = flow.items.front();
+            if (head.cost <= flow.deficit) {
+                flow.deficit -= head.cost;
+                T item = std::move(head.item);
+                flow.items.pop();
+                --_size;
+                if (flow.items.empty()) leave(flow);
+                return item;
+            }
+            // Crédit insuffisant : le client garde son crédit et passe son tour.
+            _ring.push(_ring.pop());
+            _in_turn = false;
+            if (++unpaid == _ring.size()) {
+                skipRounds();
+                unpaid = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Oublie la sous-file de `client` (déconnecté), dès qu'elle est vide.
+     */
+    void forget(const Key& client) {
+        auto it = _flows.find(client);
+        if (it == _flows.end()) return;
+        if (it->second.active) it->second.forgotten = true;
+        else _flows.erase(it);
+    }
+
+    /**
+     * @brief Abandonne tous les éléments en attente.
+     */
+    void clear() {
+        _flows.clear();
+        _ring.clear();
+        _size = 0;
+        _in_turn = false;
+    }
+
+private:
+    struct Item {
+        T item;
+        uint64_t cost = 0;
+    };
+
+    struct Flow {
+        TaskQueue<Item> items{1}; // Un client a rarement plus d'un élément en attente.
+        uint64_t deficit = 0;     // Crédit non dépensé
+        bool active = false;      // Le client est dans la ronde
+        bool forgotten = false;   // Sous-file à supprimer lorsqu'elle sera vide
+    };
+
+    uint64_t _quantum;
+    std::unordered_map<Key, Flow> _flows; // Sous-file de chaque client connu
+    TaskQueue<Key> _ring;                 // Clients ayant des éléments en attente, dans l'ordre de la ronde
+    size_t _size = 0;                     // Éléments en attente, tous clients confondus
+    bool _in_turn = false;                // Le client en tête de la ronde a déjà reçu son crédit
+
+    // Le client en tête de la ronde n'a plus rien en attente : il en sort.
+    void leave(Flow& flow) {
+        Key client = _ring.pop();
+        _in_turn = false;
+        flow.deficit = 0;
+        flow.active = false;
+        if (flow.forgotten) _flows.erase(client);
+    }
+
+    // Aucun client n'a pu payer pendant un tour complet (que des éléments coûteux) : distribue d'un
+    // coup les tours qui se seraient écoulés à vide avant que le premier d'entre eux le puisse.
+    void skipRounds() {
+        uint64_t rounds = UINT64_MAX;
+        for (auto& entry : _flows) {
+            Flow& flow = entry.second;
+            if (!flow.active) continue;
+            uint64_t missing = flow.items.front().cost - flow.deficit; // > 0 : le client n'a pas pu payer
+            rounds = std::min(rounds, (missing + _quantum - 1) / _quantum);
+        }
+        if (rounds <= 1) return;
+        for (auto& entry : _flows) {
+            if (entry.second.active) entry.second.deficit += (rounds - 1) * _quantum;
+        }
+    }
+};
+
+#endif // FAIR_QUEUE_HPP
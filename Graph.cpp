@@ -1,5 +1,8 @@
 #include "Graph.hpp"
+#include "Cancellation.hpp"
 #include "MSTFactory.hpp"
+#include "MSTSensitivity.hpp"
+#include "OutputBuffer.hpp"
 #include <algorithm>
 #include <iostream>
 #include <limits>
@@ -7,13 +10,15 @@
 #include <functional>
 #include <sstream>
 #include <memory>
+#include <tuple>
 
 // Constructor to initialize a graph with a specified number of vertices.
 Graph::Graph(int vertices) : adjList(vertices) {}
 
 // Copy constructor
 Graph::Graph(const Graph& other)
-    : adjList(other.adjList), _algorithmChoice(other._algorithmChoice) {
+    : adjList(other.adjList), _algorithmChoice(other._algorithmChoice),
+      _mstUpToDate(other._mstUpToDate), _solvedWith(other._solvedWith) {
     if (other.mst) {
         mst = std::make_unique<Graph>(*other.mst);
     }
@@ -25,6 +30,11 @@ Graph& Graph::operator=(const Graph& other) {
         adjList = other.adjList;
         _algorithmChoice = other._algorithmChoice;
         mst = other.mst ? std::make_unique<Graph>(*other.mst) : nullptr;
+        _mstUpToDate = other._mstUpToDate;
+        _solvedWith = other._solvedWith;
+        _sensitivity.reset();
+        ++_graphVersion;
+        ++_mstVersion;
     }
     return *this;
 }
@@ -35,17 +45,31 @@ Graph& Graph::operator=(Graph&& other) noexcept {
         adjList = std::move(other.adjList);
         _algorithmChoice = std::move(other._algorithmChoice);
         mst = std::move(other.mst);
+        _mstUpToDate = other._mstUpToDate;
+        _solvedWith = std::move(other._solvedWith);
+        _sensitivity = std::move(other._sensitivity);
+        ++_graphVersion;
+        ++_mstVersion;
     }
     return *this;
 }
 
+// Destructor
+Graph::~Graph() = default;
+
 // Adds an undirected edge between vertices `u` and `v` with a specified weight.
-// If an edge already exists, it updates the weight.
+// If an edge already exists, it updates the weight. Self-loops are ignored: they never belong to an
+// MST, and the edge listings (text and binary) only show each edge from its lower endpoint.
 void Graph::add_edge(int u, int v, int weight) {
-    if (isValidVertex(u) && isValidVertex(v)) {
+    if (u != v && isValidVertex(u) && isValidVertex(v)) {
+        bool existed = false;
+        int oldWeight = 0;
+
         // Remove the existing edge from u to v, if it exists
         for (auto it = adjList[u].begin(); it != adjList[u].end(); ++it) {
             if (it->first == v) {
+                existed = true;
+                oldWeight = it->second;
                 adjList[u].erase(it);
                 break;
             }
@@ -62,16 +86,21 @@ void Graph::add_edge(int u, int v, int weight) {
         // Add the new edge with the updated weight
         adjList[u].push_back({v, weight});
         adjList[v].push_back({u, weight});
+        ++_graphVersion;
+
+        updateMSTAfterEdgeChange(u, v, existed, oldWeight, weight);
     }
 }
 
 // Removes an undirected edge between vertices `u` and `v`.
 void Graph::remove_edge(int u, int v) {
     if (isValidVertex(u) && isValidVertex(v)) {
+        bool removed = false;
         auto& neighborsU = adjList[u];
         for (auto it = neighborsU.begin(); it != neighborsU.end(); ++it) {
             if (it->first == v) {
                 neighborsU.erase(it);
+                removed = true;
                 break;
             }
         }
@@ -83,6 +112,18 @@ void Graph::remove_edge(int u, int v) {
                 break;
             }
         }
+
+        if (removed) ++_graphVersion;
+
+        // Removing a non-tree edge never changes the MST (min replacements only become conservative),
+        // and a graph without spanning tree stays without one.
+        if (removed && _mstUpToDate && this->mst) {
+            if (this->mst->getNumVertices() != getNumVertices()) return;
+            const auto& treeNeighbors = this->mst->adjList[u];
+            if (std::none_of(treeNeighbors.begin(), treeNeighbors.end(),
+                             [v](const std::pair<int, int>& edge) { return edge.first == v; })) return;
+        }
+        if (removed) invalidateMST();
     }
 }
 
@@ -129,8 +170,12 @@ bool Graph::compareGraphs(Graph& other) {
 // Changes the weight of an existing undirected edge between vertices `u` and `v` to `newWeight`.
 void Graph::changeEdgeWeight(int u, int v, int newWeight) {
     if (isValidVertex(u) && isValidVertex(v)) {
+        bool existed = false;
+        int oldWeight = 0;
         for (auto& neighbor : adjList[u]) {
             if (neighbor.first == v) {
+                existed = true;
+                oldWeight = neighbor.second;
                 neighbor.second = newWeight;
             }
         }
@@ -139,46 +184,105 @@ void Graph::changeEdgeWeight(int u, int v, int newWeight) {
                 neighbor.second = newWeight;
             }
         }
+        if (existed) {
+            ++_graphVersion;
+            updateMSTAfterEdgeChange(u, v, existed, oldWeight, newWeight);
+        }
     }
 }
 
+// Each undirected edge is stored in the lists of both of its endpoints.
+size_t Graph::getNumEdges() const {
+    size_t edgeCount = 0;
+    for (const auto& neighbors : adjList) edgeCount += neighbors.size();
+    return edgeCount / 2;
+}
+
 // Provides a textual representation of the graph, showing all vertices and edges with weights.
 std::string Graph::displayGraph() {
-    std::string graphRepresentation;
-    graphRepresentation += std::string(15, ' ') + "---------------Graph Representation--------------------\n";
-    graphRepresentation += std::string(15, ' ') + "Vertices in the graph: ";
-    for (int i = 0; i < getNumVertices(); ++i) {
-        graphRepresentation += std::to_string(i) + " ";
+    OutputBuffer out;
+    writeGraph(out);
+    return out.str();
+}
+
+// Provides a textual representation of MST
+std::string Graph::displayMST() {
+    OutputBuffer out;
+    writeMST(out);
+    return out.str();
+}
+
+void Graph::writeGraph(OutputBuffer& out, size_t offset, size_t count) {
+    writeEdges(out, "---------------Graph Representation--------------------\n", offset, count);
+}
+
+void Graph::writeMST(OutputBuffer& out, size_t offset, size_t count, CancellationToken* token) {
+    this->Solve(token);
+    if (!this->mst) {
+        out.pad(15) << "---------------MST Representation----------------------\n";
+        out.pad(15) << "No MST available for this graph.\n";
+        return;
     }
-    graphRepresentation += "\n" + std::string(15, ' ') + "Connections between vertices (undirected edges):\n";
-    for (int i = 0; i < getNumVertices(); ++i) {
+    this->mst->writeEdges(out, "---------------MST Representation----------------------\n", offset, count);
+}
+
+// Formats each edge straight into `out`; a page (offset/count) skips the vertex list and the edges outside it.
+void Graph::writeEdges(OutputBuffer& out, const char* title, size_t offset, size_t count) {
+    const size_t all = static_cast<size_t>(-1);
+    bool paged = offset != 0 || count != all;
+
+    out.pad(15) << title;
+    if (paged) {
+        size_t edgeCount = getNumEdges();
+        size_t shown = offset >= edgeCount ? 0 : std::min(count, edgeCount - offset);
+        out.pad(15) << "Edges from index " << offset << " (" << shown << " of " << edgeCount << " shown):\n";
+    } else {
+        out.pad(15) << "Vertices in the graph: ";
+        for (int i = 0; i < getNumVertices(); ++i) {
+            out << i << ' ';
+        }
+        out << '\n';
+        out.pad(15) << "Connections between vertices (undirected edges):\n";
+    }
+
+    size_t index = 0;
+    for (int i = 0; i < getNumVertices() && count > 0; ++i) {
         for (const auto& neighbor : adjList[i]) {
             if (i < neighbor.first) {
-                graphRepresentation += std::string(15, ' ') + "Vertex " + std::to_string(i) + " <----(" + std::to_string(neighbor.second) + ")----> Vertex " + std::to_string(neighbor.first) + "\n";
+                if (index++ < offset) continue;
+                out.pad(15) << "Vertex " << i << " <----(" << neighbor.second << ")----> Vertex " << neighbor.first << '\n';
+                if (--count == 0) break;
             }
         }
     }
-    return graphRepresentation;
 }
 
-// Provides a textual representation of MST
-std::string Graph::displayMST() {
-    std::string graphRepresentation;
-    this->Solve();
-    graphRepresentation += std::string(15, ' ') + "---------------MST Representation----------------------\n";
-    graphRepresentation += std::string(15, ' ') + "Vertices in the graph: ";
-    for (int i = 0; i < this->mst->getNumVertices(); ++i) {
-        graphRepresentation += std::to_string(i) + " ";
-    }
-    graphRepresentation += "\n" + std::string(15, ' ') + "Connections between vertices (undirected edges):\n";
-    for (int i = 0; i < this->mst->getNumVertices(); ++i) {
-        for (const auto& neighbor : this->mst->adjList[i]) {
+void Graph::writeEdgeArray(OutputBuffer& out, size_t offset, size_t count) {
+    size_t index = 0;
+    for (int i = 0; i < getNumVertices() && count > 0; ++i) {
+        for (const auto& neighbor : adjList[i]) {
             if (i < neighbor.first) {
-                graphRepresentation += std::string(15, ' ') + "Vertex " + std::to_string(i) + " <----(" + std::to_string(neighbor.second) + ")----> Vertex " + std::to_string(neighbor.first) + "\n";
+                if (index++ < offset) continue;
+                out.writeU32(i).writeU32(neighbor.first).writeI32(neighbor.second);
+                if (--count == 0) break;
             }
         }
     }
-    return graphRepresentation;
+}
+
+// The frame length is known up front from the edge count, so the edges are streamed straight into `out`.
+void Graph::writeEdgesBinary(OutputBuffer& out, bool mstEdges, size_t offset, size_t count, CancellationToken* token) {
+    Graph* source = this;
+    if (mstEdges) {
+        this->Solve(token);
+        source = this->mst.get();
+    }
+    size_t total = source ? source->getNumEdges() : 0;
+    size_t shown = offset >= total ? 0 : std::min(count, total - offset);
+    out.writeFrameHeader(FRAME_EDGES, static_cast<uint32_t>(13 + 12 * shown));
+    out.writeU8(mstEdges ? 1 : 0).writeU32(static_cast<uint32_t>(offset));
+    out.writeU32(static_cast<uint32_t>(total)).writeU32(static_cast<uint32_t>(shown));
+    if (source) source->writeEdgeArray(out, offset, shown);
 }
 
 // Returns the total weight of all edges in the graph.
@@ -205,8 +309,21 @@ double Graph::getTotalWeight_MST() {
 
 // Finds the longest path in the MST and returns it as a formatted string.
 std::string Graph::getTreeDepthPath_MST() {
+    std::vector<int> path = getTreeDepthPathVertices_MST();
+
+    // Convert the path to a formatted string "0->9->..."
+    std::ostringstream oss;
+    for (size_t i = 0; i < path.size(); ++i) {
+        oss << path[i];
+        if (i < path.size() - 1) oss << "->";
+    }
+    return oss.str();
+}
+
+// Finds the longest path in the MST (from vertex 0 to the deepest vertex).
+std::vector<int> Graph::getTreeDepthPathVertices_MST() {
     int n = this->mst->getNumVertices();
-    if (n == 0) return "";
+    if (n == 0) return {};
 
     std::vector<int> path;
     std::vector<int> parents(n, -1); // Declare parents array to store traversal path.
@@ -242,18 +359,19 @@ std::string Graph::getTreeDepthPath_MST() {
         return maxDistance;
     };
     farthestFrom(0); // Find the deepest path.
+    return path;
+}
 
-    // Convert the path to a formatted string "0->9->..."
+// Retrieves the heaviest edge in the MST as a formatted string "u v w".
+std::string Graph::getMaxWeightEdge_MST() {
+    auto [u, v, maxWeightEdge] = getMaxWeightEdgeEndpoints_MST();
     std::ostringstream oss;
-    for (size_t i = 0; i < path.size(); ++i) {
-        oss << path[i];
-        if (i < path.size() - 1) oss << "->";
-    }
+    oss << "Vertex " << u << " <----(" << maxWeightEdge << ")----> Vertex " << v;
     return oss.str();
 }
 
-// Retrieves the heaviest edge in the MST as a formatted string "u v w".
-std::string Graph::getMaxWeightEdge_MST() {
+// Retrieves the heaviest edge in the MST as (u, v, w), (-1, -1, 0) if the MST has no edge.
+std::tuple<int, int, int> Graph::getMaxWeightEdgeEndpoints_MST() {
     int maxWeightEdge = 0;
     int u = -1, v = -1;
     for (int i = 0; i < this->mst->getNumVertices(); ++i) {
@@ -265,15 +383,32 @@ std::string Graph::getMaxWeightEdge_MST() {
             }
         }
     }
-    std::ostringstream oss;
-    oss << "Vertex " << u << " <----(" << maxWeightEdge << ")----> Vertex " << v;
-    return oss.str();
+    return {u, v, maxWeightEdge};
 }
 
 // Finds the heaviest path in the MST and returns it as a formatted string.
 std::string Graph::getMaxWeightPath_MST() {
+    if (this->mst->getNumVertices() == 0) return "Empty graph";
+    std::vector<int> path = getMaxWeightPathVertices_MST();
+
+    // Build a formatted string representation of the heaviest path.
+    std::ostringstream oss;
+    oss << "Heaviest path: ";
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        int u = path[i], v = path[i + 1];
+        auto it = std::find_if(this->mst->adjList[u].begin(), this->mst->adjList[u].end(),
+                               [v](const std::pair<int, int>& edge) { return edge.first == v; });
+        oss << u << " --(" << it->second << ")--> ";
+    }
+    oss << path.back();
+
+    return oss.str();
+}
+
+// Finds the heaviest path in the MST and returns its vertices from one end to the other.
+std::vector<int> Graph::getMaxWeightPathVertices_MST() {
     int n = this->mst->getNumVertices();
-    if (n == 0) return "Empty graph";
+    if (n == 0) return {};
 
     std::vector<int> parents(n, -1);
 
@@ -310,29 +445,13 @@ std::string Graph::getMaxWeightPath_MST() {
     std::fill(parents.begin(), parents.end(), -1);
     int end = farthestFrom(start);
 
-    // Rebuild the path as a list of vertex-weight pairs.
-    std::vector<std::pair<int, int>> maxPath;
+    // Rebuild the path from `start` to `end` by following the parents.
+    std::vector<int> maxPath;
     for (int v = end; v != -1; v = parents[v]) {
-        if (parents[v] != -1) {
-            int u = parents[v];
-            auto it = std::find_if(this->mst->adjList[u].begin(), this->mst->adjList[u].end(),
-                                   [v](const std::pair<int, int>& edge) { return edge.first == v; });
-            if (it != this->mst->adjList[u].end()) {
-                maxPath.push_back({u, it->second});
-            }
-        }
+        maxPath.push_back(v);
     }
     std::reverse(maxPath.begin(), maxPath.end());
-
-    // Build a formatted string representation of the heaviest path.
-    std::ostringstream oss;
-    oss << "Heaviest path: ";
-    for (size_t i = 0; i < maxPath.size(); ++i) {
-        oss << maxPath[i].first << " --(" << maxPath[i].second << ")--> ";
-    }
-    oss << end;
-
-    return oss.str();
+    return maxPath;
 }
 
 // Calculates the average distance between all vertex pairs in the MST.
@@ -369,6 +488,14 @@ double Graph::getAverageDistance_MST() {
 
 // Retrieves the lightest edge in the MST as a formatted string "Vertex u <----(w)----> Vertex v".
 std::string Graph::getMinWeightEdge_MST() {
+    auto [u, v, minWeightEdge] = getMinWeightEdgeEndpoints_MST();
+    std::ostringstream oss;
+    oss << "Vertex " << u << " <----(" << minWeightEdge << ")----> Vertex " << v;
+    return oss.str();
+}
+
+// Retrieves the lightest edge in the MST as (u, v, w), (-1, -1, INT_MAX) if the MST has no edge.
+std::tuple<int, int, int> Graph::getMinWeightEdgeEndpoints_MST() {
     int minWeightEdge = std::numeric_limits<int>::max();
     int u = -1, v = -1;
     for (int i = 0; i < this->mst->getNumVertices(); ++i) {
@@ -380,28 +507,197 @@ std::string Graph::getMinWeightEdge_MST() {
             }
         }
     }
-    std::ostringstream oss;
-    oss << "Vertex " << u << " <----(" << minWeightEdge << ")----> Vertex " << v;
-    return oss.str();
+    return {u, v, minWeightEdge};
+}
+
+// Converts a metric name to its AnalysisMetric bits (0 if the name is unknown).
+unsigned parseAnalysisMetric(const std::string& name) {
+    if (name == "all") return ANALYSIS_ALL;
+    if (name == "graph") return ANALYSIS_GRAPH;
+    if (name == "mst") return ANALYSIS_MST;
+    if (name == "weight") return ANALYSIS_WEIGHT;
+    if (name == "average" || name == "avg") return ANALYSIS_AVERAGE;
+    if (name == "depth" || name == "longest") return ANALYSIS_DEPTH;
+    if (name == "heaviest") return ANALYSIS_HEAVIEST_PATH;
+    if (name == "maxedge") return ANALYSIS_MAX_EDGE;
+    if (name == "minedge") return ANALYSIS_MIN_EDGE;
+    return 0;
+}
+
+// Builds the analysis from the requested sections only; unrequested metrics are never computed.
+std::string Graph::Analysis(unsigned metrics) {
+    OutputBuffer out;
+    writeAnalysis(out, metrics);
+    return out.str();
+}
+
+void Graph::writeAnalysis(OutputBuffer& out, unsigned metrics, CancellationToken* token) {
+    out << '\n';
+    if (metrics & ANALYSIS_GRAPH) writeGraph(out);
+    if (!(metrics & ~ANALYSIS_GRAPH)) return;
+
+    this->Solve(token);
+    if (!this->mst) {
+        out.pad(15) << "No MST available for this graph.\n\n";
+        return;
+    }
+    if (metrics & ANALYSIS_MST) writeMST(out);
+    if (!(metrics & ~(ANALYSIS_GRAPH | ANALYSIS_MST))) return;
+
+    out.pad(15) << "------------------MST Analysis-------------------------\n";
+    out.pad(15) << "Algorithm: " << _algorithmChoice << '\n';
+    for (unsigned metric = ANALYSIS_WEIGHT; metric & ANALYSIS_ALL; metric <<= 1) {
+        if (metrics & metric) out << getAnalysisSection(static_cast<AnalysisMetric>(metric));
+    }
+    out.pad(15) << "-------------------------------------------------------\n\n";
+}
+
+unsigned Graph::getAvailableSections(unsigned metrics, CancellationToken* token) {
+    metrics &= ANALYSIS_ALL;
+    if (metrics & ~ANALYSIS_GRAPH) {
+        this->Solve(token);
+        if (!this->mst) metrics &= ANALYSIS_GRAPH;
+    }
+    return metrics;
+}
+
+void Graph::writeAnalysisBinary(OutputBuffer& out, unsigned metrics, CancellationToken* token) {
+    metrics = getAvailableSections(metrics, token);
+
+    // Compute the payload size first: the edge arrays have a fixed size per edge, the other sections are memoized.
+    size_t payloadSize = 4;
+    for (unsigned metric = ANALYSIS_GRAPH; metric & ANALYSIS_ALL; metric <<= 1) {
+        if (!(metrics & metric)) continue;
+        if (metric == ANALYSIS_GRAPH) payloadSize += 8 + 12 * getNumEdges();
+        else if (metric == ANALYSIS_MST) payloadSize += 8 + 12 * this->mst->getNumEdges();
+        else payloadSize += getBinarySection(static_cast<AnalysisMetric>(metric)).size();
+    }
+
+    out.writeFrameHeader(FRAME_ANALYSIS, static_cast<uint32_t>(payloadSize)).writeU32(metrics);
+    for (unsigned metric = ANALYSIS_GRAPH; metric & ANALYSIS_ALL; metric <<= 1) {
+        if (!(metrics & metric)) continue;
+        if (metric == ANALYSIS_GRAPH || metric == ANALYSIS_MST) writeBinarySection(out, static_cast<AnalysisMetric>(metric));
+        else out << getBinarySection(static_cast<AnalysisMetric>(metric));
+    }
+}
+
+const std::string& Graph::getAnalysisSection(AnalysisMetric metric, CancellationToken* token) {
+    return getCachedSection(metric, false, token);
+}
+
+const std::string& Graph::getBinarySection(AnalysisMetric metric, CancellationToken* token) {
+    return getCachedSection(metric, true, token);
+}
+
+// Returns the memoized text of one section, recomputing it only if the graph or MST changed since.
+const std::string& Graph::getCachedSection(AnalysisMetric metric, bool binary, CancellationToken* token) {
+    int index = 0;
+    while (!(metric & (1u << index))) ++index;
+
+    if (metric != ANALYSIS_GRAPH) this->Solve(token);
+    unsigned long version = metric == ANALYSIS_GRAPH ? _graphVersion : _mstVersion;
+    std::string& section = _sectionCache[binary][index];
+    if (_sectionVersion[binary][index] == version) return section;
+
+    const std::string padding(15, ' ');
+    if (metric != ANALYSIS_GRAPH && !this->mst) section.clear();
+    else if (binary) {
+        OutputBuffer out;
+        writeBinarySection(out, metric);
+        section = out.str();
+    }
+    else switch (metric) {
+        case ANALYSIS_GRAPH:         section = displayGraph(); break;
+        case ANALYSIS_MST:           section = displayMST(); break;
+        case ANALYSIS_WEIGHT:        section = padding + "Total MST weight: " + std::to_string(getTotalWeight_MST()) + "\n"; break;
+        case ANALYSIS_AVERAGE:       section = padding + "Average distance: " + std::to_string(getAverageDistance_MST()) + "\n"; break;
+        case ANALYSIS_DEPTH:         section = padding + "Longest path: " + getTreeDepthPath_MST() + "\n"; break;
+        case ANALYSIS_HEAVIEST_PATH: section = padding + "Heaviest path: " + getMaxWeightPath_MST() + "\n"; break;
+        case ANALYSIS_MAX_EDGE:      section = padding + "Heaviest edge: " + getMaxWeightEdge_MST() + "\n"; break;
+        case ANALYSIS_MIN_EDGE:      section = padding + "Lightest edge: " + getMinWeightEdge_MST() + "\n"; break;
+        default:                     section.clear(); break;
+    }
+    _sectionVersion[binary][index] = version;
+    return section;
+}
+
+// Encodes one section as documented on writeAnalysisBinary; MST sections expect `Solve` to have produced an MST.
+void Graph::writeBinarySection(OutputBuffer& out, AnalysisMetric metric) {
+    auto writePath = [&out](const std::vector<int>& path) {
+        out.writeU32(static_cast<uint32_t>(path.size()));
+        for (int v : path) out.writeU32(v);
+    };
+    auto writeEdge = [&out](const std::tuple<int, int, int>& edge) {
+        out.writeI32(std::get<0>(edge)).writeI32(std::get<1>(edge)).writeI32(std::get<2>(edge));
+    };
+    switch (metric) {
+        case ANALYSIS_GRAPH:
+            out.writeU32(getNumVertices()).writeU32(static_cast<uint32_t>(getNumEdges()));
+            writeEdgeArray(out, 0, static_cast<size_t>(-1));
+            break;
+        case ANALYSIS_MST:
+            out.writeU32(this->mst->getNumVertices()).writeU32(static_cast<uint32_t>(this->mst->getNumEdges()));
+            this->mst->writeEdgeArray(out, 0, static_cast<size_t>(-1));
+            break;
+        case ANALYSIS_WEIGHT:        out.writeF64(getTotalWeight_MST()); break;
+        case ANALYSIS_AVERAGE:       out.writeF64(getAverageDistance_MST()); break;
+        case ANALYSIS_DEPTH:         writePath(getTreeDepthPathVertices_MST()); break;
+        case ANALYSIS_HEAVIEST_PATH: writePath(getMaxWeightPathVertices_MST()); break;
+        case ANALYSIS_MAX_EDGE:      writeEdge(getMaxWeightEdgeEndpoints_MST()); break;
+        case ANALYSIS_MIN_EDGE:      writeEdge(getMinWeightEdgeEndpoints_MST()); break;
+        default: break;
+    }
+}
+
+// Returns the [low, high] weight range of edge (u, v) for which the current MST stays optimal.
+std::pair<int, int> Graph::getEdgeSensitivity_MST(int u, int v) {
+    this->Solve();
+    if (!this->mst || this->mst->getNumVertices() != getNumVertices()) {
+        return {std::numeric_limits<int>::max(), std::numeric_limits<int>::min()}; // No MST: empty range.
+    }
+    if (!_sensitivity) _sensitivity = std::make_unique<MSTSensitivity>(*this, *this->mst);
+    return _sensitivity->getRange(u, v);
+}
+
+bool Graph::isMSTUpToDate() const {
+    return _mstUpToDate && _solvedWith == _algorithmChoice;
+}
+
+// Patches the MST in place when the update provably keeps it optimal, otherwise invalidates it.
+void Graph::updateMSTAfterEdgeChange(int u, int v, bool existed, int oldWeight, int newWeight) {
+    if (!_mstUpToDate) return;
+    // Without a spanning tree a new edge may connect the graph, so a full solve is needed.
+    if (!this->mst || this->mst->getNumVertices() != getNumVertices()) {
+        invalidateMST();
+        return;
+    }
+    if (!_sensitivity) _sensitivity = std::make_unique<MSTSensitivity>(*this, *this->mst);
+
+    if (_sensitivity->isTreeEdge(u, v)) {
+        if (newWeight <= _sensitivity->getMinReplacement(u, v)) {
+            this->mst->changeEdgeWeight(u, v, newWeight);
+            _sensitivity->updateTreeEdge(u, v, newWeight);
+            ++_mstVersion;
+            return;
+        }
+    } else if (newWeight >= _sensitivity->getMaxOnPath(u, v)) {
+        // A lighter (or new) non-tree edge may become the min replacement of the edges on its path.
+        if (!existed || newWeight < oldWeight) {
+            _sensitivity->relaxNonTreeEdge(u, v, newWeight);
+        }
+        return;
+    }
+    invalidateMST();
 }
 
-std::string Graph::Analysis() {
-    std::string _Analysis = "";
-    _Analysis +="\n"+displayGraph() + displayMST();
-    _Analysis += std::string(15, ' ') + "------------------MST Analysis-------------------------\n";
-    _Analysis += std::string(15, ' ') + "Algorithm: " + _algorithmChoice + "\n";
-    _Analysis += std::string(15, ' ') + "Total MST weight: " + std::to_string(getTotalWeight_MST()) + "\n";
-    _Analysis += std::string(15, ' ') + "Average distance: " + std::to_string(getAverageDistance_MST()) + "\n";
-    _Analysis += std::string(15, ' ') + "Longest path: " + getTreeDepthPath_MST() + "\n";
-    _Analysis += std::string(15, ' ') + "Heaviest path: " + getMaxWeightPath_MST() + "\n";
-    _Analysis += std::string(15, ' ') + "Heaviest edge: " + getMaxWeightEdge_MST() + "\n";
-    _Analysis += std::string(15, ' ') + "Lightest edge: " + getMinWeightEdge_MST() + "\n";
-    _Analysis += std::string(15, ' ') + "-------------------------------------------------------\n\n";
-    return _Analysis;
+void Graph::invalidateMST() {
+    _mstUpToDate = false;
+    _sensitivity.reset();
 }
 
-void Graph::Solve() {
+void Graph::Solve(CancellationToken* token) {
     if (this->getNumVertices() == 0) {return ;}
+    if (isMSTUpToDate() && this->mst) {return;}
     std::unique_ptr<MSTFactory> algo;
     if (_algorithmChoice == "prim") algo = std::make_unique<PrimSolver>();
     else if (_algorithmChoice == "kruskal") algo = std::make_unique<KruskalSolver>();
@@ -409,5 +705,10 @@ void Graph::Solve() {
     else if (_algorithmChoice == "tarjan") algo = std::make_unique<TarjanSolver>();
     else if (_algorithmChoice == "integer_mst") algo = std::make_unique<IntegerMSTSolver>();
     if (!algo) {return;}
-        this->mst = std::make_unique<Graph>(algo->solveMST(*this));
+        this->mst = std::make_unique<Graph>(algo->solveMST(*this, token));
+    if (token) token->setProgress(1.0);
+    ++_mstVersion;
+    _mstUpToDate = true;
+    _solvedWith = _algorithmChoice;
+    _sensitivity.reset();
 }
\ No newline at end of file
@@ -6,6 +6,34 @@
 #include <memory>
 #include <utility>
 #include <string>
+#include <array>
+#include <tuple>
+
+class MSTSensitivity;
+class OutputBuffer;
+class CancellationToken;
+
+/*
+ * Sections of the graph analysis, combined as a bitmask to select what `Graph::Analysis` computes.
+ * Only the requested sections are evaluated, and each one is memoized until the graph (for
+ * ANALYSIS_GRAPH) or the MST (for all the others) changes.
+ */
+enum AnalysisMetric : unsigned {
+    ANALYSIS_GRAPH         = 1u << 0,  // Full graph dump.
+    ANALYSIS_MST           = 1u << 1,  // Full MST dump.
+    ANALYSIS_WEIGHT        = 1u << 2,  // Total MST weight.
+    ANALYSIS_AVERAGE       = 1u << 3,  // Average distance between vertex pairs.
+    ANALYSIS_DEPTH         = 1u << 4,  // Longest (deepest) path.
+    ANALYSIS_HEAVIEST_PATH = 1u << 5,  // Heaviest path.
+    ANALYSIS_MAX_EDGE      = 1u << 6,  // Heaviest edge.
+    ANALYSIS_MIN_EDGE      = 1u << 7,  // Lightest edge.
+    ANALYSIS_ALL           = (1u << 8) - 1
+};
+constexpr int ANALYSIS_SECTION_COUNT = 8;
+
+// Converts a metric name ("graph", "mst", "weight", "average", "depth", "heaviest", "maxedge",
+// "minedge" or "all") to its AnalysisMetric bits. Returns 0 for an unknown name.
+unsigned parseAnalysisMetric(const std::string& name);
 
 /*
  * The Graph class represents an undirected weighted graph using an adjacency list structure.
@@ -42,6 +70,14 @@ public:
     std::vector<std::list<std::pair<int, int>>> adjList;
     std::string _algorithmChoice = "prim";
     std::unique_ptr<Graph> mst;
+    // True while `mst` is optimal for the current edges and was produced by `_solvedWith`.
+    bool _mstUpToDate = false;
+    std::string _solvedWith;
+    // Weight ranges of the current MST, built lazily on the first edge update after a solve.
+    std::unique_ptr<MSTSensitivity> _sensitivity;
+    // Incremented on every edge change (graph) and every change of the MST (solve or in-place patch).
+    unsigned long _graphVersion = 1;
+    unsigned long _mstVersion = 1;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //                          Functions primarily used for random Graph                                //
@@ -55,7 +91,9 @@ public:
     Graph& operator=(const Graph& other);
     // Move assignment operator
     Graph& operator=(Graph&& other) noexcept;
-    // Adds an edge between vertices `u` and `v` with the specified weight.
+    // Destructor (defined out of line because MSTSensitivity is incomplete here)
+    ~Graph();
+    // Adds an edge between vertices `u` and `v` with the specified weight (ignored if u == v).
     void add_edge(int u, int v, int weight);
     // Removes an edge between vertices `u` and `v`.
     void remove_edge(int u, int v);
@@ -69,6 +107,8 @@ public:
     bool compareGraphs(Graph& other);
     // Changes the weight of an existing undirected edge between vertices `u` and `v` to `newWeight`.
     void changeEdgeWeight(int u, int v, int newWeight);
+    // Returns the number of undirected edges in the graph.
+    size_t getNumEdges() const;
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //            Functions primarily used for MST (Minimum Spanning Tree) operations                    //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +120,11 @@ public:
     std::string displayGraph();
     // Displays the MST structure, showing each vertex and its connected edges.
     std::string displayMST();
+    // Streams the graph display into `out`. With an `offset` or a `count`, only that page of edges is written.
+    void writeGraph(OutputBuffer& out, size_t offset = 0, size_t count = static_cast<size_t>(-1));
+    // Streams the MST display into `out`, optionally limited to a page of edges like `writeGraph`.
+    // The MST is solved first under `token` if it is stale (see Solve).
+    void writeMST(OutputBuffer& out, size_t offset = 0, size_t count = static_cast<size_t>(-1), CancellationToken* token = nullptr);
     // Finds the longest path in the MST (returns a string representing the path in the format "0->9->...").
     std::string getTreeDepthPath_MST();
     // Retrieves the heaviest edge in the MST (returns a string in the format "u v w",
@@ -89,10 +134,43 @@ public:
     std::string getMaxWeightPath_MST();
     // Retrieves the lightest edge in the MST (returns a string in the format "u v w").
     std::string getMinWeightEdge_MST();
+    // Vertices of the longest path in the MST, from vertex 0 to the deepest vertex.
+    std::vector<int> getTreeDepthPathVertices_MST();
+    // Vertices of the heaviest path in the MST, from one end to the other.
+    std::vector<int> getMaxWeightPathVertices_MST();
+    // Heaviest edge of the MST as (u, v, w); (-1, -1, 0) if the MST has no edge.
+    std::tuple<int, int, int> getMaxWeightEdgeEndpoints_MST();
+    // Lightest edge of the MST as (u, v, w); (-1, -1, INT_MAX) if the MST has no edge.
+    std::tuple<int, int, int> getMinWeightEdgeEndpoints_MST();
     // Calculates the average distance between all pairs of vertices (Xi, Xj) in the MST.
     double getAverageDistance_MST();
-    // Performs a comprehensive analysis of the graph and its MST and stores the results
-    std::string Analysis();
+    // Returns the [low, high] range of weights over which edge (u, v) leaves the current MST unchanged.
+    std::pair<int, int> getEdgeSensitivity_MST(int u, int v);
+    // Returns true if the stored MST is still optimal for the current edges, i.e. `Solve` has nothing to do.
+    bool isMSTUpToDate() const;
+    // Performs an analysis of the graph and its MST limited to the `metrics` sections (AnalysisMetric bits).
+    std::string Analysis(unsigned metrics = ANALYSIS_ALL);
+    // Streams the same analysis into `out`; the graph and MST displays are written without being memoized.
+    // Like every method below taking a `token`, a stale MST is solved under it first (see Solve).
+    void writeAnalysis(OutputBuffer& out, unsigned metrics = ANALYSIS_ALL, CancellationToken* token = nullptr);
+    // Returns the formatted line(s) of a single analysis section, computed on first use for the current MST.
+    const std::string& getAnalysisSection(AnalysisMetric metric, CancellationToken* token = nullptr);
+    // Returns the `metrics` sections that an analysis actually contains: without an MST only the graph is left.
+    unsigned getAvailableSections(unsigned metrics, CancellationToken* token = nullptr);
+    /* Binary analysis: writes one FRAME_ANALYSIS frame whose payload is the u32 mask of the sections
+     * present (see getAvailableSections) followed by each section in bit order:
+     *  - GRAPH, MST:           u32 vertices, u32 edges, then per edge u32 u, u32 v, i32 w
+     *  - WEIGHT, AVERAGE:      f64
+     *  - DEPTH, HEAVIEST_PATH: u32 n, then n x u32 vertex
+     *  - MAX_EDGE, MIN_EDGE:   i32 u, i32 v, i32 w
+     * The graph and MST edge arrays are streamed into `out` without being memoized. */
+    void writeAnalysisBinary(OutputBuffer& out, unsigned metrics = ANALYSIS_ALL, CancellationToken* token = nullptr);
+    // Returns the memoized binary encoding of a single section (as laid out by writeAnalysisBinary).
+    const std::string& getBinarySection(AnalysisMetric metric, CancellationToken* token = nullptr);
+    /* Writes a page of the graph (or MST) edges as one FRAME_EDGES frame:
+     *     u8 source (0 graph, 1 MST), u32 offset, u32 total edges, u32 n, then n x (u32 u, u32 v, i32 w) */
+    void writeEdgesBinary(OutputBuffer& out, bool mstEdges, size_t offset = 0, size_t count = static_cast<size_t>(-1),
+                          CancellationToken* token = nullptr);
     /* The Solve method is designed to execute the primary algorithm associated with the graph.
      * Depending on the context, this method could:
      *  - Construct the Minimum Spanning Tree (MST) of the graph using the algorithm specified
@@ -104,8 +182,31 @@ public:
      * or results are computed based on the input and selected algorithm.
      *
      * The results or changes performed by this function can be accessed through other member functions
-     * such as `displayGraph`, `displayMST`, or `Analysis`*/
-    void Solve();
+     * such as `displayGraph`, `displayMST`, or `Analysis`
+     *
+     * With a `token`, the solver can be cancelled or given a deadline (OperationCancelled is thrown
+     * and the graph, previous MST included, is left unchanged) and reports its progress through it. */
+    void Solve(CancellationToken* token = nullptr);
+
+private:
+    // Memoized analysis sections (text, then binary) and the graph/MST version each one was computed for.
+    std::array<std::array<std::string, ANALYSIS_SECTION_COUNT>, 2> _sectionCache;
+    std::array<std::array<unsigned long, ANALYSIS_SECTION_COUNT>, 2> _sectionVersion{};
+
+    // Returns the memoized text or binary encoding of a section, recomputing it if it is stale.
+    const std::string& getCachedSection(AnalysisMetric metric, bool binary, CancellationToken* token);
+    // Writes the binary encoding of a section, without memoization.
+    void writeBinarySection(OutputBuffer& out, AnalysisMetric metric);
+    // Writes the representation of this graph's edges under `title` (see writeGraph for paging).
+    void writeEdges(OutputBuffer& out, const char* title, size_t offset, size_t count);
+    // Writes `count` edges starting at edge index `offset` as (u32 u, u32 v, i32 w) triples.
+    void writeEdgeArray(OutputBuffer& out, size_t offset, size_t count);
 
+    /* Called after the edge (u, v) changed from `oldWeight` (if it `existed`) to `newWeight`.
+     * When the new weight stays inside the edge's sensitivity range the MST is patched in place and
+     * stays valid, so the next `Solve` is skipped; otherwise the MST is marked as out of date. */
+    void updateMSTAfterEdgeChange(int u, int v, bool existed, int oldWeight, int newWeight);
+    // Marks the MST as out of date and drops the sensitivity data built for it.
+    void invalidateMST();
 };
 #endif // GRAPH_HPP
\ No newline at end of file
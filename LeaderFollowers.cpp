@@ -1,20 +1,178 @@
 #include "LeaderFollowers.hpp"
-#include <iostream>
-#include <sstream>
+#include "Logger.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+// Pool et indice du thread courant, s'il appartient à un pool (sinon nul).
+thread_local LeaderFollowers* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+// Nœuds de tâches libres : chaque thread a son cache, et les caches s'équilibrent par lots de
+// NODE_BATCH nœuds à travers une réserve commune. Un nœud libéré par le thread qui a volé la tâche
+// revient ainsi à celui qui soumet, et les nœuds circulent sans allocation en régime établi.
+constexpr size_t NODE_BATCH = 128;
+struct SpareNodes {
+    std::mutex mutex;
+    std::vector<LeaderFollowers::Task*> nodes;
+    ~SpareNodes() {
+        for (LeaderFollowers::Task* node : nodes) delete node;
+    }
+};
+SpareNodes spare_nodes;
+
+struct TaskNodeCache {
+    std::vector<LeaderFollowers::Task*> nodes;
+    TaskNodeCache() { nodes.reserve(2 * NODE_BATCH); }
+    ~TaskNodeCache() {
+        for (LeaderFollowers::Task* node : nodes) delete node;
+    }
+};
+thread_local TaskNodeCache node_cache;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
 
 /**
- * @brief Constructeur.
- * Initialise les variables internes et crée les threads du pool.
+ * @brief Constructeur d'un pool de taille fixe.
  *
  * @param num_threads Nombre de threads dans le pool.
+ * @param handler Gestionnaire des événements des descripteurs surveillés.
+ * @param cpus Cœur de chaque thread (vide : threads non fixés).
+ */
+LeaderFollowers::LeaderFollowers(int num_threads, EventHandler handler, const CpuSet& cpus)
+    : LeaderFollowers(num_threads, num_threads, std::move(handler), cpus) {}
+
+/**
+ * @brief Constructeur.
+ * Crée l'ensemble surveillé (avec l'eventfd des tâches et celui d'arrêt), les files des
+ * `max_threads` places, les `min_threads` premiers threads et, si le pool peut grandir, le superviseur.
  */
-LeaderFollowers::LeaderFollowers(int num_threads) : _running(true), _leader_active(false) {
-    // Crée `num_threads` threads qui exécuteront tous la méthode `worker_loop`.
-    for (int i = 0; i < num_threads; ++i) {
-        _threads.emplace_back(&LeaderFollowers::worker_loop, this); // Ajoute un thread dans le pool.
+LeaderFollowers::LeaderFollowers(int min_threads, int max_threads, EventHandler handler, const CpuSet& cpus)
+    : _handler(std::move(handler)), _live_threads(0), _cpus(cpus), _leader_active(false), _running(true) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _task_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_epoll_fd < 0 || _task_fd < 0 || _stop_fd < 0) {
+        throw std::runtime_error("[LeaderFollowers] Failed to create the handle set.");
+    }
+
+    // Ces deux descripteurs restent armés : l'eventfd des tâches est vidé par le leader avant la
+    // promotion (et le reste y est réécrit), et celui d'arrêt n'est jamais lu afin de réveiller
+    // chaque leader successif.
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _task_fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _task_fd, &event);
+    event.data.fd = _stop_fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _stop_fd, &event);
+
+    // Une file et une place par thread possible ; les `min_threads` premières places démarrent tout de suite.
+    _min_threads = min_threads > 0 ? static_cast<size_t>(min_threads) : 1;
+    _max_threads = std::max(_min_threads, max_threads > 0 ? static_cast<size_t>(max_threads) : 1);
+    for (size_t i = 0; i < _max_threads; ++i) {
+        _local_tasks.push_back(std::make_unique<ChaseLevDeque<Task*>>());
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < _min_threads; ++i) {
+        spawn(i); // Ajoute un thread dans le pool.
+    }
+    if (_max_threads > _min_threads) {
+        _supervisor = std::thread(&LeaderFollowers::supervise, this);
     }
 }
 
+void LeaderFollowers::spawn(size_t index) {
+    Worker& worker = *_workers[index];
+    worker.exited.store(false, std::memory_order_relaxed);
+    worker.busy_since.store(0, std::memory_order_relaxed);
+    _live_threads.fetch_add(1, std::memory_order_relaxed);
+    worker.thread = std::thread(&LeaderFollowers::worker_loop, this, index);
+    if (index < _cpus.size() && !pinThread(worker.thread, _cpus[index])) {
+        LOG_WARNING("[LeaderFollowers] Failed to pin thread ", index, " to CPU ", _cpus[index], ".");
+    }
+}
+
+size_t LeaderFollowers::pending_tasks() {
+    size_t count = 0;
+    for (auto& local : _local_tasks) count += local->size();
+    std::lock_guard<std::mutex> lock(_inject_mutex);
+    return count + _injected.size();
+}
+
+/**
+ * @brief Boucle du superviseur.
+ *
+ * Toutes les `SAMPLE_INTERVAL`, compte les threads occupés (et, parmi eux, ceux qui traitent la
+ * même requête depuis plus de `BLOCKED_AFTER`) et les tâches en attente. Si aucun thread n'est
+ * libre, un thread est ajouté, dans une place libre ou libérée par un thread terminé, dès que l'un
+ * d'eux est bloqué ou lorsque des tâches attendent depuis `GROW_SAMPLES` observations.
+ */
+void LeaderFollowers::supervise() {
+    int saturated = 0; // Observations consécutives avec des tâches en attente et aucun thread libre
+    std::unique_lock<std::mutex> lock(_supervisor_mutex);
+    while (_running) {
+        _supervisor_cv.wait_for(lock, SAMPLE_INTERVAL);
+        if (!_running) break;
+
+        int64_t now = now_ns();
+        size_t busy = 0, blocked = 0, free_slot = _max_threads;
+        for (size_t i = 0; i < _max_threads; ++i) {
+            Worker& worker = *_workers[i];
+            if (worker.exited.load(std::memory_order_acquire)) {
+                worker.thread.join();
+                worker.exited.store(false, std::memory_order_relaxed);
+            }
+            if (!worker.thread.joinable()) {
+                if (free_slot == _max_threads) free_slot = i;
+                continue;
+            }
+            int64_t since = worker.busy_since.load(std::memory_order_relaxed);
+            if (since == 0) continue;
+            ++busy;
+            if (now - since > std::chrono::duration_cast<std::chrono::nanoseconds>(BLOCKED_AFTER).count()) ++blocked;
+        }
+
+        // Tous les threads occupés : plus aucun leader n'attend sur l'ensemble surveillé, donc les
+        // événements des clients attendent aussi (sans être visibles dans les files de tâches).
+        size_t live = _live_threads.load(std::memory_order_relaxed);
+        if (free_slot == _max_threads || busy < live) {
+            saturated = 0;
+            continue;
+        }
+        if (pending_tasks() > 0) ++saturated;
+        if (saturated >= GROW_SAMPLES || blocked > 0) {
+            saturated = 0;
+            spawn(free_slot);
+            LOG_DEBUG("[LeaderFollowers] Pool grown to ", live + 1, " threads (", blocked, " blocked).");
+            // Les tâches en attente (dans la file d'un thread bloqué, par exemple) n'ont plus
+            // d'unité sur l'eventfd : une unité fait passer le nouveau thread par les files.
+            if (pending_tasks() > 0) {
+                uint64_t one = 1;
+                if (write(_task_fd, &one, sizeof(one)) < 0) {
+                    LOG_ERROR("[LeaderFollowers] Failed to signal a task.");
+                }
+            }
+        }
+    }
+}
+
+bool LeaderFollowers::retire(size_t index) {
+    size_t live = _live_threads.load(std::memory_order_relaxed);
+    do {
+        if (live <= _min_threads) return false;
+    } while (!_live_threads.compare_exchange_weak(live, live - 1, std::memory_order_relaxed));
+    // La file du thread est vide : il l'a vidée avant de redevenir follower, et lui seul y ajoute.
+    LOG_DEBUG("[LeaderFollowers] Idle thread ", index, " retired, ", live - 1, " left.");
+    return true;
+}
+
 /**
  * @brief Destructeur.
  *
@@ -22,102 +180,276 @@ LeaderFollowers::LeaderFollowers(int num_threads) : _running(true), _leader_acti
  */
 LeaderFollowers::~LeaderFollowers() {
     stop(); // Arrête proprement tous les threads avant la destruction.
+    // Libère les tâches qui n'ont pas été exécutées.
+    Task* task;
+    for (auto& local : _local_tasks) {
+        while (local->pop(task)) delete task;
+    }
+    while (!_injected.empty()) delete _injected.pop();
+    close(_epoll_fd);
+    close(_task_fd);
+    close(_stop_fd);
+}
+
+void LeaderFollowers::watch(int fd, uint32_t events) {
+    epoll_event event{};
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+void LeaderFollowers::rearm(int fd, uint32_t events) {
+    epoll_event event{};
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void LeaderFollowers::unwatch(int fd) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
 }
 
 /**
- * @brief Ajoute une tâche dans la file d'attente.
+ * @brief Ajoute une tâche.
  *
- * Cette méthode utilise un mutex pour garantir que l'accès à la file est thread-safe.
+ * La tâche va dans la file du thread appelant s'il appartient au pool, sinon dans la file
+ * d'injection ; une unité de l'eventfd des tâches rend l'ensemble surveillé prêt.
  *
  * @param task La tâche à ajouter.
  */
-void LeaderFollowers::add_task(const Task& task) {
+void LeaderFollowers::add_task(Task task) {
+    push_task(make_node(std::move(task)));
+    uint64_t one = 1;
+    if (write(_task_fd, &one, sizeof(one)) < 0) {
+        LOG_ERROR("[LeaderFollowers] Failed to signal a task.");
+    }
+}
+
+/**
+ * @brief Ajoute plusieurs tâches.
+ *
+ * Une seule écriture du nombre de tâches sur l'eventfd (et une seule prise du verrou d'injection
+ * hors du pool).
+ *
+ * @param tasks Les tâches à ajouter.
+ */
+void LeaderFollowers::add_tasks(std::vector<Task> tasks) {
+    if (tasks.empty()) return;
+    uint64_t count = tasks.size();
+    if (current_pool == this) {
+        for (Task& task : tasks) _local_tasks[current_index]->push(make_node(std::move(task)));
+    } else {
+        std::lock_guard<std::mutex> lock(_inject_mutex);
+        for (Task& task : tasks) _injected.push(make_node(std::move(task)));
+    }
+    if (write(_task_fd, &count, sizeof(count)) < 0) {
+        LOG_ERROR("[LeaderFollowers] Failed to signal ", count, " task(s).");
+    }
+}
+
+void LeaderFollowers::push_task(Task* task) {
+    if (current_pool == this) {
+        _local_tasks[current_index]->push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(_inject_mutex);
+        _injected.push(task);
+    }
+}
+
+LeaderFollowers::Task* LeaderFollowers::find_task(size_t index) {
+    Task* task = nullptr;
+    if (_local_tasks[index]->pop(task)) return task;
+    Task* batch[MAX_BATCH];
+    size_t count = 0;
     {
-        std::lock_guard<std::mutex> lock(_queue_mutex); // Verrouille l'accès à la file des tâches.
-        _task_queue.push(task); // Ajoute la tâche à la file d'attente.
+        std::lock_guard<std::mutex> lock(_inject_mutex);
+        while (count < MAX_BATCH && !_injected.empty()) batch[count++] = _injected.pop();
+    }
+    if (count > 0) {
+        // Le reste du lot passe dans la file du thread, où les autres peuvent le voler ; empilé à
+        // rebours pour que ce thread le reprenne dans l'ordre d'arrivée.
+        for (size_t i = count - 1; i > 0; --i) _local_tasks[index]->push(batch[i]);
+        return batch[0];
+    }
+    // Vol : les autres files sont parcourues à partir du voisin, pour étaler les voleurs.
+    for (size_t i = 1; i < _max_threads; ++i) {
+        if (_local_tasks[(index + i) % _max_threads]->steal(task)) return task;
+    }
+    return nullptr;
+}
+
+void LeaderFollowers::run_task(Task* task) {
+    try {
+        if (*task) (*task)();
+    } catch (const std::exception& e) { // Une tâche en échec n'empêche pas les suivantes.
+        LOG_ERROR("[LeaderFollowers] Task exception: ", e.what());
+    }
+    release_node(task);
+}
+
+LeaderFollowers::Task* LeaderFollowers::make_node(Task&& task) {
+    std::vector<Task*>& nodes = node_cache.nodes;
+    if (nodes.empty()) {
+        std::lock_guard<std::mutex> lock(spare_nodes.mutex);
+        size_t count = std::min(NODE_BATCH, spare_nodes.nodes.size());
+        nodes.insert(nodes.end(), spare_nodes.nodes.end() - count, spare_nodes.nodes.end());
+        spare_nodes.nodes.resize(spare_nodes.nodes.size() - count);
+    }
+    if (nodes.empty()) return new Task(std::move(task));
+    Task* node = node_cache.nodes.back();
+    node_cache.nodes.pop_back();
+    *node = std::move(task);
+    return node;
+}
+
+void LeaderFollowers::release_node(Task* node) {
+    *node = nullptr; // Libère tout de suite les captures de la tâche.
+    std::vector<Task*>& nodes = node_cache.nodes;
+    if (nodes.size() == 2 * NODE_BATCH) {
+        std::lock_guard<std::mutex> lock(spare_nodes.mutex);
+        spare_nodes.nodes.insert(spare_nodes.nodes.end(), nodes.end() - NODE_BATCH, nodes.end());
+        nodes.resize(NODE_BATCH);
+    }
+    nodes.push_back(node);
+}
+
+void LeaderFollowers::run_tasks(size_t index) {
+    while (_running) {
+        Task* task = find_task(index);
+        if (!task) return;
+        run_task(task);
+        // Tous les threads exécutent des tâches : ce thread retourne sur l'ensemble surveillé, pour que
+        // les événements des clients ne restent pas derrière toutes les tâches en attente. L'unité
+        // rendue au compteur fait reprendre les tâches restantes.
+        if (!_leader_active.load(std::memory_order_relaxed)) {
+            uint64_t one = 1;
+            if (write(_task_fd, &one, sizeof(one)) < 0) {
+                LOG_ERROR("[LeaderFollowers] Failed to signal a task.");
+            }
+            return;
+        }
+    }
+}
+
+bool LeaderFollowers::is_worker_thread() const {
+    return current_pool == this;
+}
+
+void LeaderFollowers::wait_until(const std::function<bool()>& done) {
+    while (!done()) {
+        Task* task = current_pool == this ? find_task(current_index) : nullptr;
+        if (task) run_task(task);
+        else std::this_thread::yield();
     }
-    _cv.notify_one(); // Réveille un thread en attente pour qu'il traite la tâche.
 }
 
 /**
  * @brief Arrête proprement le pool de threads.
  *
- * Réveille tous les threads pour qu'ils quittent leur boucle principale
- * et attend leur terminaison avec `join`.
+ * Réveille le leader (via l'eventfd d'arrêt) et les followers (via la condition), puis attend la
+ * terminaison de tous les threads avec `join`.
  */
 void LeaderFollowers::stop() {
     {
-        std::lock_guard<std::mutex> lock(_queue_mutex); // Verrouille pour protéger la variable `_running`.
+        std::lock_guard<std::mutex> lock(_leader_mutex);
         _running = false; // Signale que le pool de threads doit s'arrêter.
     }
-    _cv.notify_all(); // Réveille tous les threads qui attendent dans `worker_loop`.
+    uint64_t one = 1;
+    if (write(_stop_fd, &one, sizeof(one)) < 0) {
+        LOG_ERROR("[LeaderFollowers] Failed to wake the leader.");
+    }
+    _cv.notify_all(); // Réveille tous les followers.
+    {
+        std::lock_guard<std::mutex> lock(_supervisor_mutex);
+    }
+    _supervisor_cv.notify_all();
+    if (_supervisor.joinable()) _supervisor.join(); // Plus aucun thread ne peut être ajouté.
 
     // Parcourt tous les threads du pool pour les arrêter proprement.
-    for (auto& thread : _threads) {
-        if (thread.joinable()) { // Vérifie que le thread est toujours actif.
-            thread.join(); // Attend la fin de l'exécution du thread.
+    for (auto& worker : _workers) {
+        if (worker->thread.joinable()) { // Vérifie que le thread est toujours actif.
+            worker->thread.join(); // Attend la fin de l'exécution du thread.
         }
     }
 }
 
+void LeaderFollowers::promote_new_leader() {
+    {
+        std::lock_guard<std::mutex> lock(_leader_mutex);
+        _leader_active = false;
+    }
+    _cv.notify_one(); // Un follower devient le nouveau leader.
+}
+
 /**
  * @brief Boucle principale des threads.
  *
  * Chaque thread :
- * - Attend une tâche ou un signal d'arrêt.
- * - Tente de devenir leader pour exécuter une tâche.
- * - Libère le rôle de leader après exécution.
+ * - Attend que le rôle de leader soit libre (follower), puis le prend.
+ * - En tant que leader, attend un événement sur l'ensemble surveillé.
+ * - Prend possession de l'événement, promeut un follower, puis traite l'événement.
+ * - Exécute ensuite les tâches qu'il trouve (les siennes, injectées ou volées).
+ *
+ * @param index Indice du thread (et de sa file de tâches).
  */
-void LeaderFollowers::worker_loop() {
-    while (_running) { // Continue tant que `_running` est `true`.
-        Task task; // Conteneur pour stocker la tâche à exécuter.
-
+void LeaderFollowers::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+    Worker& worker = *_workers[index];
+    while (true) {
         {
-            std::unique_lock<std::mutex> lock(_queue_mutex); // Verrouille l'accès à la file des tâches.
-
-            // Attend qu'une tâche soit disponible ou qu'un signal d'arrêt soit émis.
-            _cv.wait(lock, [this]() {
-                return !_running || !_task_queue.empty(); // Condition de réveil : arrêt ou tâche disponible.
-            });
-
-            // Si le pool est arrêté et qu'il n'y a plus de tâches, quitter la boucle.
-            if (!_running && _task_queue.empty()) return;
-
-            // Début de la définition du thread leader
-            if (!_leader_active.exchange(true)) { // Si aucun autre thread n'est leader, ce thread devient leader.
-                {
-                    std::lock_guard<std::mutex> log_lock(_log_mutex); // Verrouille l'accès aux logs.
-                    std::ostringstream oss;
-                    oss << "[LeaderFollowers] Thread " << std::this_thread::get_id() << " became leader.";
-                    std::cout << oss.str() << std::endl; // Affiche que ce thread est devenu leader.
-                }
+            std::unique_lock<std::mutex> lock(_leader_mutex);
+            bool woken = _cv.wait_for(lock, IDLE_TIMEOUT, [this]() { return !_running || !_leader_active; });
+            if (!_running) return;
+            if (!woken) {
+                // Follower inoccupé depuis IDLE_TIMEOUT : il se termine si le pool dépasse son minimum.
+                if (!retire(index)) continue;
+                lock.unlock();
+                current_pool = nullptr;
+                worker.exited.store(true, std::memory_order_release);
+                return;
+            }
+            _leader_active = true; // Ce thread devient leader.
+        }
 
-                if (!_task_queue.empty()) { // Vérifie si une tâche est disponible.
-                    task = std::move(_task_queue.front()); // Récupère la tâche en tête de file.
-                    _task_queue.pop(); // Supprime la tâche de la file.
-                }
+        // Le leader attend un événement sur l'ensemble des descripteurs.
+        epoll_event event{};
+        int count;
+        do {
+            count = epoll_wait(_epoll_fd, &event, 1, -1);
+        } while (count < 0 && errno == EINTR && _running);
 
-                _leader_active = false; // Libère le rôle de leader pour permettre à d'autres threads de devenir leader.
-            }
+        if (count <= 0 || !_running || event.data.fd == _stop_fd) {
+            promote_new_leader(); // Laisse les autres threads constater l'arrêt.
+            if (!_running) return;
+            continue;
         }
 
-        // Début de l'exécution de la tâche par le leader
-        if (task) { // Si une tâche a été récupérée.
-            try {
-                {
-                    std::lock_guard<std::mutex> log_lock(_log_mutex); // Verrouille l'accès aux logs.
-                    std::ostringstream oss;
-                    oss << "[LeaderFollowers] Thread " << std::this_thread::get_id() << " is executing a task.";
-                    std::cout << oss.str() << std::endl; // Affiche que ce thread exécute une tâche.
+        // Une unité par tâche soumise : s'il en reste, d'autres threads sont réveillés à leur tour
+        // (au plus un par thread du pool, les tâches n'étant pas liées aux unités) pour se répartir
+        // les tâches en attente.
+        if (event.data.fd == _task_fd) {
+            uint64_t pending;
+            if (read(_task_fd, &pending, sizeof(pending)) == sizeof(pending) && pending > 1) {
+                uint64_t rest = std::min<uint64_t>(pending - 1, thread_count() - 1);
+                if (write(_task_fd, &rest, sizeof(rest)) < 0) {
+                    LOG_ERROR("[LeaderFollowers] Failed to signal a task.");
                 }
-                task(); // Exécute la tâche.
-            } catch (const std::exception& e) { // Capture les exceptions levées par la tâche.
-                std::lock_guard<std::mutex> log_lock(_log_mutex); // Verrouille les logs pour signaler une erreur.
-                std::cerr << "[LeaderFollowers] Task exception: " << e.what() << std::endl; // Affiche l'erreur.
             }
         }
 
-        // Fin de l'exécution de la tâche par le leader
-        _cv.notify_one(); // Réveille un autre thread en attente pour qu'il devienne leader.
+        promote_new_leader();
+        worker.busy_since.store(now_ns(), std::memory_order_relaxed);
+
+        // Traitement de l'événement par l'ancien leader, devenu "processing thread".
+        if (event.data.fd != _task_fd) {
+            try {
+                if (_handler) _handler(event.data.fd, event.events);
+            } catch (const std::exception& e) { // Capture les exceptions levées par le traitement.
+                LOG_ERROR("[LeaderFollowers] Task exception: ", e.what()); // Affiche l'erreur.
+            }
+        }
+        run_tasks(index);
+        worker.busy_since.store(0, std::memory_order_relaxed);
     }
-}
\ No newline at end of file
+}
@@ -1,39 +1,93 @@
+#ifndef LEADERFOLLOWERS_HPP
+#define LEADERFOLLOWERS_HPP
+
 #include <vector>               // Pour utiliser std::vector pour gérer les threads
-#include <queue>                // Pour std::queue pour la file des tâches
+#include <memory>               // Pour std::unique_ptr (files des threads)
 #include <thread>               // Pour std::thread pour gérer les threads
 #include <mutex>                // Pour std::mutex pour la synchronisation
-#include <condition_variable>   // Pour std::condition_variable pour réveiller les threads
+#include <condition_variable>   // Pour std::condition_variable pour réveiller les followers
 #include <atomic>               // Pour std::atomic pour des opérations atomiques
-#include <functional>           // Pour std::function pour représenter les tâches
+#include <functional>           // Pour std::function pour le gestionnaire d'événements
+#include <cstdint>              // Pour uint32_t (masques d'événements epoll)
+#include <exception>            // Pour transmettre les exceptions des tâches aux futurs
+#include <optional>             // Pour la valeur d'un futur
+#include <type_traits>          // Pour le type de retour des tâches soumises
+#include <algorithm>            // Pour std::min et std::max (découpage des boucles parallèles)
+#include <chrono>               // Pour les délais de l'ajustement du nombre de threads
+#include "CpuAffinity.hpp"      // Placement des threads sur les cœurs
+#include "ChaseLevDeque.hpp"    // File de tâches propre à chaque thread, volable par les autres
+#include "TaskQueue.hpp"        // File d'injection
+#include "UniqueTask.hpp"       // Tâches non copiables, sans allocation pour les petites captures
+
+template <typename R> class TaskFuture;
 
 /**
  * @class LeaderFollowers
  * @brief Implémente le modèle de gestion des threads "Leader/Followers".
  *
- * Ce modèle repose sur une répartition dynamique des rôles entre les threads.
- * - Un thread devient "leader" pour exécuter une tâche, tandis que les autres
- *   threads restent en veille et tentent de devenir leader lorsqu'il se libère.
+ * Les threads du pool se partagent un ensemble de descripteurs surveillés par epoll :
+ * - Un seul thread, le leader, attend un événement sur cet ensemble (`epoll_wait`).
+ * - Dès qu'il en obtient un, il promeut un follower au rang de leader, puis traite lui-même
+ *   l'événement. Aucune file ne sépare la détection d'un événement de son traitement : il n'y a
+ *   ni transfert entre threads ni changement de contexte par requête.
+ * - Les autres threads (followers) attendent leur tour de devenir leader.
+ *
+ * Les descripteurs sont surveillés en EPOLLONESHOT : un événement livré désactive le descripteur
+ * jusqu'à ce que le gestionnaire le réarme (`rearm`), si bien qu'un même client n'est jamais
+ * traité par deux threads à la fois.
+ *
+ * Des tâches peuvent aussi être soumises avec `add_task`, selon un ordonnancement par vol de
+ * travail : chaque thread du pool a sa propre file (Chase–Lev) où vont les tâches qu'il soumet
+ * lui-même, et les tâches soumises par d'autres threads passent par une file d'injection. Chaque
+ * tâche ajoute une unité à un eventfd de l'ensemble surveillé : le leader qui reçoit cet événement
+ * en réveille un autre s'il reste des unités, puis, comme tout thread qui a fini de traiter son
+ * événement, exécute des tâches (les siennes d'abord, puis celles de la file d'injection, puis
+ * celles volées aux autres threads) jusqu'à ne plus en trouver. Il n'y a plus de verrou commun à
+ * toutes les tâches, et un thread qui attend des sous-tâches (`wait_until`) en exécute au lieu de
+ * bloquer, ce qui permet le fork-join imbriqué sur le pool sans interblocage.
+ *
+ * `submit` renvoie un `TaskFuture` pour récupérer le résultat d'une tâche (ou enchaîner une suite
+ * avec `then`), et `parallel_for` / `parallel_reduce` découpent une boucle en tâches du pool : un
+ * calcul lancé par une requête peut ainsi utiliser les threads existants du serveur.
+ *
+ * Le nombre de threads peut varier entre un minimum et un maximum. Un superviseur observe le pool
+ * toutes les `SAMPLE_INTERVAL` : si des tâches attendent alors qu'aucun thread n'est libre depuis
+ * `GROW_SAMPLES` observations (ou tout de suite si un thread est bloqué sur une même tâche depuis
+ * plus de `BLOCKED_AFTER`, typiquement un gros calcul de MST), il ajoute un thread, pour que les
+ * requêtes légères ne restent pas derrière les lourdes. À l'inverse, un follower resté sans rôle
+ * pendant `IDLE_TIMEOUT` se termine tant que le pool dépasse son minimum. Chaque thread possible a
+ * sa file de tâches dès la construction : un thread ajouté reprend la place (et la file, vide)
+ * d'un thread terminé.
  */
 class LeaderFollowers {
 public:
 
-    using Task=std::function<void()>;        // Alias pour représenter une tâche : une fonction sans argument ni retour.
-    std::queue<Task>         _task_queue;    // File contenant les tâches en attente d'exécution
-    std::vector<std::thread> _threads;       // Liste des threads du pool
-    std::mutex               _queue_mutex;   // Mutex pour protéger l'accès à la file des tâches
-    std::condition_variable  _cv;            // Condition variable pour synchroniser les threads
-    std::atomic<bool>        _running;       // Indique si le pool est actif ou arrêté
-    std::atomic<bool>        _leader_active; // Indique si un thread est actuellement leader
-    std::mutex               _log_mutex;     // Mutex pour protéger les affichages console/logs
+    using Task=UniqueTask;                                     // Alias pour représenter une tâche : une fonction sans argument ni retour, non copiable.
+    using EventHandler=std::function<void(int, uint32_t)>;     // Gestionnaire d'un événement (descripteur, masque epoll).
 
+    static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{5};  ///< Période d'observation du superviseur.
+    static constexpr int GROW_SAMPLES = 2;                           ///< Observations saturées avant d'ajouter un thread.
+    static constexpr std::chrono::milliseconds BLOCKED_AFTER{50};    ///< Durée d'un traitement au-delà de laquelle son thread est bloqué.
+    static constexpr std::chrono::milliseconds IDLE_TIMEOUT{1000};   ///< Attente d'un follower avant qu'il se termine.
+    static constexpr size_t MAX_BATCH = 32;                          ///< Tâches prises au plus par prise du verrou d'injection.
 
     /**
      * @brief Constructeur.
      * Initialise le pool de threads avec un nombre spécifié de threads.
      *
      * @param num_threads Nombre de threads à créer dans le pool.
+     * @param handler Gestionnaire appelé (par le leader qui l'a reçu) pour chaque événement d'un
+     *                descripteur ajouté avec `watch`.
+     * @param cpus Cœur de chaque thread, dans l'ordre (vide : threads non fixés).
      */
-    explicit LeaderFollowers(int num_threads);
+    explicit LeaderFollowers(int num_threads, EventHandler handler = nullptr, const CpuSet& cpus = {});
+
+    /**
+     * @brief Constructeur d'un pool élastique, de `min_threads` à `max_threads` threads.
+     *
+     * @param cpus Cœur de chaque place de thread, dans l'ordre (vide : threads non fixés).
+     */
+    LeaderFollowers(int min_threads, int max_threads, EventHandler handler = nullptr, const CpuSet& cpus = {});
 
     /**
      * @brief Destructeur.
@@ -41,14 +95,81 @@ public:
      */
     ~LeaderFollowers();
 
+    /**
+     * @brief Ajoute un descripteur à l'ensemble surveillé.
+     *
+     * @param fd Le descripteur (socket d'écoute ou client).
+     * @param events Les événements attendus (EPOLLIN...) ; EPOLLONESHOT est toujours ajouté.
+     */
+    void watch(int fd, uint32_t events);
+
+    /**
+     * @brief Réarme un descripteur après le traitement de son événement.
+     */
+    void rearm(int fd, uint32_t events);
+
+    /**
+     * @brief Retire un descripteur de l'ensemble surveillé (avant de le fermer).
+     */
+    void unwatch(int fd);
+
     /**
      * @brief Ajoute une tâche à la file d'attente.
      *
-     * Cette méthode est thread-safe grâce à un verrou (`std::mutex`).
+     * Cette méthode est thread-safe. La tâche est déplacée dans un nœud recyclé : en régime établi,
+     * soumettre une tâche dont la capture tient dans `UniqueTask::INLINE_SIZE` n'alloue rien.
      *
      * @param task La tâche à ajouter.
      */
-    void add_task(const Task& task);
+    void add_task(Task task);
+
+    /**
+     * @brief Ajoute plusieurs tâches en une seule prise du verrou et une seule écriture sur l'eventfd.
+     */
+    void add_tasks(std::vector<Task> tasks);
+
+    /**
+     * @brief Attend que `done()` soit vrai.
+     *
+     * Appelée depuis un thread du pool (par une tâche qui attend ses sous-tâches), elle exécute les
+     * tâches disponibles en attendant au lieu de bloquer le thread. Depuis un autre thread, elle
+     * attend simplement.
+     */
+    void wait_until(const std::function<bool()>& done);
+
+    /**
+     * @brief Indique si le thread appelant est un thread de ce pool.
+     */
+    bool is_worker_thread() const;
+
+    /**
+     * @brief Nombre de threads actuellement en vie.
+     */
+    size_t thread_count() const { return _live_threads.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Soumet `function` et renvoie le futur de son résultat (ou de son exception).
+     */
+    template <typename F>
+    TaskFuture<std::invoke_result_t<std::decay_t<F>&>> submit(F&& function);
+
+    /**
+     * @brief Exécute `body(lo, hi)` sur des tranches de [begin, end) réparties sur le pool.
+     *
+     * Le thread appelant traite la première tranche, puis attend les autres (en aidant s'il fait
+     * partie du pool). La première exception levée par une tranche est relancée à la fin.
+     *
+     * @param grain Taille d'une tranche (0 : environ quatre tranches par thread).
+     */
+    template <typename Index, typename Body>
+    void parallel_for(Index begin, Index end, Body body, Index grain = 0);
+
+    /**
+     * @brief Réduit [begin, end) : `map(lo, hi)` pour chaque tranche, puis `combine` des résultats
+     * dans l'ordre des tranches, à partir de `identity`.
+     */
+    template <typename Index, typename T, typename Map, typename Combine>
+    T parallel_reduce(Index begin, Index end, T identity, Map map, Combine combine, Index grain = 0);
 
     /**
      * @brief Arrête le pool de threads.
@@ -57,11 +178,326 @@ public:
      */
     void stop();
 
+private:
+    // Place d'un thread du pool.
+    struct Worker {
+        std::thread          thread;
+        std::atomic<bool>    exited{false};   // Le thread a quitté sa boucle (il reste à le joindre)
+        std::atomic<int64_t> busy_since{0};   // Début du traitement en cours, en ns (0 : en attente)
+    };
+
+    EventHandler             _handler;       // Gestionnaire des événements des descripteurs surveillés
+    int                      _epoll_fd;      // Ensemble des descripteurs surveillés
+    int                      _task_fd;       // eventfd compteur : une unité par tâche en attente
+    int                      _stop_fd;       // eventfd écrit par `stop` pour réveiller le leader
+    std::vector<std::unique_ptr<ChaseLevDeque<Task*>>> _local_tasks; // File de tâches de chaque thread
+    TaskQueue<Task*>         _injected;      // Tâches soumises hors du pool
+    std::mutex               _inject_mutex;  // Protège la file d'injection
+    std::vector<std::unique_ptr<Worker>> _workers; // Places des threads (`_max_threads`), occupées ou non
+    size_t                   _min_threads;   // Nombre minimal de threads
+    size_t                   _max_threads;   // Nombre maximal de threads (et de files de tâches)
+    std::atomic<size_t>      _live_threads;  // Nombre de threads en vie
+    CpuSet                   _cpus;          // Cœur de chaque place de thread (vide : non fixés)
+    std::thread              _supervisor;    // Ajuste le nombre de threads (pool élastique uniquement)
+    std::mutex               _supervisor_mutex;
+    std::condition_variable  _supervisor_cv; // Réveille le superviseur lors de l'arrêt
+    std::mutex               _leader_mutex;  // Mutex protégeant le rôle de leader
+    std::condition_variable  _cv;            // Réveille un follower lorsque le rôle de leader se libère
+    std::atomic<bool>        _leader_active; // Indique si un thread est actuellement leader (modifié sous `_leader_mutex`)
+    std::atomic<bool>        _running;       // Indique si le pool est actif ou arrêté
+
     /**
      * @brief Boucle principale exécutée par chaque thread.
      *
-     * Les threads tentent de devenir leader pour exécuter une tâche.
-     * Ceux qui ne sont pas leaders restent en veille jusqu'à ce qu'une tâche soit disponible.
+     * Le thread attend de devenir leader, attend un événement, promeut un follower, puis traite
+     * l'événement et les tâches disponibles avant de redevenir follower.
+     *
+     * @param index Indice du thread (et de sa file de tâches).
+     */
+    void worker_loop(size_t index);
+
+    /**
+     * @brief Démarre un thread à la place `index` (libre).
+     */
+    void spawn(size_t index);
+
+    /**
+     * @brief Boucle du superviseur : observe le pool et ajoute des threads lorsqu'il est saturé.
+     */
+    void supervise();
+
+    /**
+     * @brief Fait terminer le follower appelant si le pool dépasse son minimum.
+     * @return true si le thread doit quitter sa boucle.
      */
-    void worker_loop();
-};
\ No newline at end of file
+    bool retire(size_t index);
+
+    /**
+     * @brief Nombre approximatif de tâches en attente (files des threads et file d'injection).
+     */
+    size_t pending_tasks();
+
+    /**
+     * @brief Ajoute une tâche à la file du thread appelant s'il appartient au pool, sinon à la
+     * file d'injection.
+     */
+    void push_task(Task* task);
+
+    /**
+     * @brief Cherche une tâche pour le thread `index` : sa file, la file d'injection, puis les autres files.
+     *
+     * La file d'injection est vidée par lots de `MAX_BATCH` tâches sous une seule prise de son
+     * verrou : le thread exécute la première et garde les autres dans sa propre file.
+     */
+    Task* find_task(size_t index);
+
+    /**
+     * @brief Exécute les tâches disponibles jusqu'à ne plus en trouver, ou jusqu'à ce que plus aucun
+     * leader n'attende sur l'ensemble surveillé.
+     */
+    void run_tasks(size_t index);
+
+    /**
+     * @brief Exécute une tâche puis rend son nœud au cache du thread.
+     */
+    static void run_task(Task* task);
+
+    /**
+     * @brief Nœud de tâche pris dans le cache du thread appelant, rempli au besoin depuis la réserve
+     * commune (alloué si les deux sont vides).
+     */
+    static Task* make_node(Task&& task);
+
+    /**
+     * @brief Vide un nœud et le rend au cache du thread appelant (dont la moitié passe dans la réserve
+     * commune s'il est plein).
+     */
+    static void release_node(Task* node);
+
+    /**
+     * @brief Libère le rôle de leader et réveille un follower pour qu'il le prenne.
+     */
+    void promote_new_leader();
+
+    // Prépare la tâche de `function` dans `batch` (soumis ensuite avec `add_tasks`) et renvoie son futur.
+    template <typename F>
+    TaskFuture<std::invoke_result_t<std::decay_t<F>&>> package(F&& function, std::vector<Task>& batch);
+
+    // Taille de tranche par défaut pour [0, count) : environ quatre tranches par thread.
+    template <typename Index>
+    Index default_grain(Index count) const {
+        Index chunks = static_cast<Index>(4 * std::max<size_t>(1, thread_count()));
+        return std::max<Index>(1, count / chunks);
+    }
+};
+
+/**
+ * @class TaskFuture
+ * @brief Résultat à venir d'une tâche soumise à un LeaderFollowers.
+ *
+ * `get` attend le résultat : depuis un thread du pool, en exécutant d'autres tâches pendant
+ * l'attente (pas d'interblocage en fork-join) ; depuis un autre thread, en dormant. `then`
+ * enchaîne une suite exécutée sur le pool dès que le résultat est prêt, sans bloquer personne ;
+ * une exception se propage le long des suites sans les exécuter. Comme `std::future`, un
+ * `TaskFuture` se consomme une seule fois (par `get` ou par `then`).
+ */
+template <typename R>
+class TaskFuture {
+public:
+    TaskFuture() = default;
+
+    bool valid() const { return _state != nullptr; }
+
+    bool ready() const { return _state->done.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Attend le résultat puis le renvoie (ou relance l'exception de la tâche).
+     */
+    R get() {
+        std::shared_ptr<State> state = std::move(_state);
+        if (!state->done.load(std::memory_order_acquire)) {
+            if (state->pool->is_worker_thread()) {
+                state->pool->wait_until([&state]() { return state->done.load(std::memory_order_acquire); });
+            } else {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->cv.wait(lock, [&state]() { return state->done.load(std::memory_order_relaxed); });
+            }
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->error) std::rethrow_exception(state->error);
+        if constexpr (!std::is_void_v<R>) return std::move(*state->value);
+    }
+
+    /**
+     * @brief Enchaîne `next`, appelé sur un thread du pool avec le résultat (sans argument si R est void).
+     * @return Le futur du résultat de `next`.
+     */
+    template <typename F>
+    auto then(F&& next) {
+        using Next = std::decay_t<F>;
+        using NextResult = typename std::conditional_t<std::is_void_v<R>, std::invoke_result<Next&>,
+                                                        std::invoke_result<Next&, R>>::type;
+        std::shared_ptr<State> state = std::move(_state);
+        TaskFuture<NextResult> result(state->pool);
+        UniqueTask continuation([state, nextState = result._state, next = Next(std::forward<F>(next))]() mutable {
+            if (state->error) {
+                nextState->finish([&]() { nextState->error = state->error; });
+                return;
+            }
+            TaskFuture<NextResult>::run(nextState, [&]() -> NextResult {
+                if constexpr (std::is_void_v<R>) return next();
+                else return next(std::move(*state->value));
+            });
+        });
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            done = state->done.load(std::memory_order_relaxed);
+            if (!done) state->continuation = std::move(continuation);
+        }
+        if (done) state->pool->add_task(std::move(continuation));
+        return result;
+    }
+
+private:
+    template <typename> friend class TaskFuture;
+    friend class LeaderFollowers;
+
+    // État partagé entre la tâche, le futur et l'éventuelle suite.
+    struct State {
+        explicit State(LeaderFollowers* pool) : pool(pool) {}
+
+        LeaderFollowers* pool;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<bool> done{false};
+        std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> value;
+        std::exception_ptr error;
+        UniqueTask continuation; // Suite enregistrée par `then` avant la fin de la tâche.
+
+        // Publie le résultat écrit par `set`, réveille les attentes et planifie la suite.
+        template <typename Set>
+        void finish(Set set) {
+            UniqueTask next;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                set();
+                done.store(true, std::memory_order_release);
+                next = std::move(continuation);
+            }
+            cv.notify_all();
+            if (next) pool->add_task(std::move(next));
+        }
+    };
+
+    std::shared_ptr<State> _state;
+
+    explicit TaskFuture(LeaderFollowers* pool) : _state(std::make_shared<State>(pool)) {}
+
+    // Exécute `function` et publie son résultat ou son exception dans `state`.
+    template <typename Function>
+    static void run(const std::shared_ptr<State>& state, Function&& function) {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                function();
+                state->finish([&state]() { state->value.emplace(true); });
+            } else {
+                R value = function();
+                state->finish([&state, &value]() { state->value.emplace(std::move(value)); });
+            }
+        } catch (...) {
+            std::exception_ptr error = std::current_exception();
+            state->finish([&state, &error]() { state->error = error; });
+        }
+    }
+};
+
+template <typename F>
+TaskFuture<std::invoke_result_t<std::decay_t<F>&>> LeaderFollowers::submit(F&& function) {
+    using Result = std::invoke_result_t<std::decay_t<F>&>;
+    TaskFuture<Result> future(this);
+    add_task([state = future._state, function = std::decay_t<F>(std::forward<F>(function))]() mutable {
+        TaskFuture<Result>::run(state, function);
+    });
+    return future;
+}
+
+template <typename F>
+TaskFuture<std::invoke_result_t<std::decay_t<F>&>> LeaderFollowers::package(F&& function, std::vector<Task>& batch) {
+    using Result = std::invoke_result_t<std::decay_t<F>&>;
+    TaskFuture<Result> future(this);
+    batch.emplace_back([state = future._state, function = std::decay_t<F>(std::forward<F>(function))]() mutable {
+        TaskFuture<Result>::run(state, function);
+    });
+    return future;
+}
+
+template <typename Index, typename Body>
+void LeaderFollowers::parallel_for(Index begin, Index end, Body body, Index grain) {
+    if (!(begin < end)) return;
+    if (grain <= 0) grain = default_grain<Index>(end - begin);
+
+    Index first = begin + std::min<Index>(grain, end - begin);
+    // Les autres tranches partent en un seul lot : une prise du verrou, une écriture sur l'eventfd.
+    std::vector<TaskFuture<void>> parts;
+    std::vector<Task> batch;
+    for (Index lo = first; lo < end;) {
+        Index hi = lo + std::min<Index>(grain, end - lo);
+        parts.push_back(package([&body, lo, hi]() { body(lo, hi); }, batch));
+        lo = hi;
+    }
+    add_tasks(std::move(batch));
+
+    // Toutes les tranches référencent `body` : on les attend toutes avant de relancer une exception.
+    std::exception_ptr error;
+    try {
+        body(begin, first);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& part : parts) {
+        try {
+            part.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+template <typename Index, typename T, typename Map, typename Combine>
+T LeaderFollowers::parallel_reduce(Index begin, Index end, T identity, Map map, Combine combine, Index grain) {
+    if (!(begin < end)) return identity;
+    if (grain <= 0) grain = default_grain<Index>(end - begin);
+
+    Index first = begin + std::min<Index>(grain, end - begin);
+    std::vector<TaskFuture<T>> parts;
+    std::vector<Task> batch;
+    for (Index lo = first; lo < end;) {
+        Index hi = lo + std::min<Index>(grain, end - lo);
+        parts.push_back(package([&map, lo, hi]() { return map(lo, hi); }, batch));
+        lo = hi;
+    }
+    add_tasks(std::move(batch));
+
+    std::exception_ptr error;
+    T result = std::move(identity);
+    try {
+        result = combine(std::move(result), map(begin, first));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& part : parts) {
+        try {
+            T partial = part.get();
+            if (!error) result = combine(std::move(result), std::move(partial));
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+    return result;
+}
+
+#endif // LEADERFOLLOWERS_HPP
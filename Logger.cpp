@@ -1,5 +1,168 @@
 #include "Logger.hpp"
+#include "SpscRing.hpp" // Pour SpinThenPark (attente du thread de fond)
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/**
+ * File circulaire bornée sans verrou pour plusieurs producteurs et un consommateur (Vyukov).
+ *
+ * Chaque case porte un numéro de séquence : un producteur réserve une case par compare-and-swap
+ * sur `_tail`, la remplit, puis publie la séquence ; le consommateur lit les cases dans l'ordre de
+ * réservation et ne s'arrête qu'à la première case pas encore publiée.
+ */
+class LogRing {
+public:
+    static constexpr size_t CAPACITY = 1024; // Puissance de deux.
+
+    LogRing() : _slots(new Slot[CAPACITY]) {
+        for (size_t i = 0; i < CAPACITY; ++i) _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Producteurs : false si la file est pleine.
+    bool try_push(LogLevel level, const LogLine& line) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = _slots[tail & MASK];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == tail) {
+                if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) break;
+            } else if (sequence < tail) {
+                return false;
+            } else {
+                tail = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        Slot& slot = _slots[tail & MASK];
+        slot.level = level;
+        slot.size = line.size();
+        std::memcpy(slot.text, line.data(), line.size());
+        slot.sequence.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consommateur : ajoute le message le plus ancien à `out`, false si aucun n'est publié.
+    bool try_pop(std::string& out) {
+        Slot& slot = _slots[_head & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != _head + 1) return false;
+        switch (slot.level) {
+        case LogLevel::Debug: out += "[DEBUG] "; break;
+        case LogLevel::Warning: out += "[WARNING] "; break;
+        case LogLevel::Error: out += "[ERROR] "; break;
+        default: break;
+        }
+        out.append(slot.text, slot.size);
+        out += '\n';
+        slot.sequence.store(_head + CAPACITY, std::memory_order_release);
+        ++_head;
+        return true;
+    }
+
+    bool empty() const {
+        return _slots[_head & MASK].sequence.load(std::memory_order_acquire) != _head + 1;
+    }
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::Info;
+        size_t size = 0;
+        char text[LOG_LINE_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    alignas(64) std::atomic<size_t> _tail{0}; // Prochaine case à réserver (producteurs)
+    alignas(64) size_t _head = 0;             // Prochaine case à lire (consommateur)
+};
+
+// File et thread de fond, créés au premier message et arrêtés à la fin du programme.
+class AsyncLogger {
+public:
+    AsyncLogger() : _thread([this]() { drain(); }) {}
+
+    ~AsyncLogger() {
+        _stopping.store(true, std::memory_order_release);
+        _notEmpty.notify_always();
+        _thread.join();
+    }
+
+    void push(LogLevel level, const LogLine& line) {
+        if (!_ring.try_push(level, line)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        _accepted.fetch_add(1, std::memory_order_release);
+        _notEmpty.notify();
+    }
+
+    void flush() {
+        size_t target = _accepted.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(_flushMutex);
+        ++_flushWaiters;
+        _flushed.wait(lock, [this, target]() { return _written.load(std::memory_order_acquire) >= target; });
+        --_flushWaiters;
+    }
+
+private:
+    LogRing _ring;
+    std::atomic<bool> _stopping{false};
+    std::atomic<size_t> _dropped{0};
+    std::atomic<size_t> _accepted{0}; // Messages entrés dans la file
+    std::atomic<size_t> _written{0};  // Messages écrits par le thread de fond
+    SpinThenPark _notEmpty;
+    std::mutex _flushMutex;           // Protège `_flushWaiters` (appels à flushLogs, rares)
+    std::condition_variable _flushed;
+    size_t _flushWaiters = 0;
+    std::thread _thread;
+
+    void drain() {
+        std::string batch;
+        for (;;) {
+            _notEmpty.wait([this]() { return !_ring.empty() || _stopping.load(std::memory_order_acquire); });
+            size_t count = 0;
+            while (_ring.try_pop(batch)) ++count;
+            size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) batch += "[WARNING] [Logger] " + std::to_string(dropped) + " message(s) dropped.\n";
+            if (!batch.empty()) {
+                std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                std::cout.flush();
+                batch.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(_flushMutex);
+                _written.fetch_add(count, std::memory_order_release);
+                if (_flushWaiters > 0) _flushed.notify_all();
+            }
+            if (count == 0 && _stopping.load(std::memory_order_acquire)) return;
+        }
+    }
+};
+
+AsyncLogger& logger() {
+    static AsyncLogger instance;
+    return instance;
+}
+
+} // namespace
+
+void setLogLevel(LogLevel level) {
+    logger_detail::runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void logPush(LogLevel level, const LogLine& line) {
+    logger().push(level, line);
+}
+
+void flushLogs() {
+    logger().flush();
+}
 
 void log(const std::string& message) {
-    std::cout << message << std::endl;
-}
\ No newline at end of file
+    LOG_INFO(message);
+}
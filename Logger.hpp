@@ -1,9 +1,125 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
-#include <iostream>
+#include <atomic>       // Pour le niveau choisi à l'exécution
+#include <charconv>     // Pour std::to_chars (entiers formatés sans allocation)
+#include <cstdio>       // Pour std::snprintf (flottants)
+#include <cstring>      // Pour std::memcpy
 #include <string>
+#include <string_view>
+#include <type_traits>
 
+/**
+ * Journal asynchrone.
+ *
+ * Un message est formaté par le thread appelant dans un tampon de taille fixe sur sa pile, puis
+ * copié dans une file circulaire bornée sans verrou (plusieurs producteurs, un consommateur) ; un
+ * thread de fond la vide et écrit les messages par lots sur `std::cout`, avec un seul `flush` par
+ * lot. Journaliser ne prend donc ni verrou ni allocation et ne fait aucune écriture système. Si la
+ * file est pleine, le message est abandonné (le thread de fond signale combien l'ont été) : un
+ * journal ne doit jamais ralentir une requête.
+ *
+ * Les macros `LOG_DEBUG`, `LOG_INFO`, `LOG_WARNING` et `LOG_ERROR` prennent une liste de morceaux
+ * (chaînes, nombres, caractères) concaténés dans l'ordre. En dessous de `LOG_MIN_LEVEL` (fixé à la
+ * compilation, Info par défaut), l'appel disparaît entièrement : ses arguments ne sont même pas
+ * évalués. Au-dessus, un niveau choisi à l'exécution (`setLogLevel`) filtre avant tout formatage.
+ * Un message plus long que `LOG_LINE_SIZE` est tronqué.
+ */
+
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4 };
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 1 // Info : les journaux de débogage ne sont compilés qu'avec -DLOG_MIN_LEVEL=0.
+#endif
+
+constexpr size_t LOG_LINE_SIZE = 240; ///< Taille maximale d'un message, niveau compris.
+
+/**
+ * @brief Ligne en cours de formatage, sur la pile du thread appelant.
+ */
+class LogLine {
+public:
+    void append(std::string_view text) {
+        size_t count = text.size() < LOG_LINE_SIZE - _size ? text.size() : LOG_LINE_SIZE - _size;
+        std::memcpy(_data + _size, text.data(), count);
+        _size += count;
+    }
+    void append(const char* text) { append(std::string_view(text)); }
+    void append(const std::string& text) { append(std::string_view(text)); }
+    void append(char c) { append(std::string_view(&c, 1)); }
+    void append(bool value) { append(value ? std::string_view("true") : std::string_view("false")); }
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    void append(T value) {
+        char buffer[32];
+        if constexpr (std::is_integral<T>::value) {
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+        } else {
+            int count = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+            append(std::string_view(buffer, count > 0 ? static_cast<size_t>(count) : 0));
+        }
+    }
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    char _data[LOG_LINE_SIZE];
+    size_t _size = 0;
+};
+
+namespace logger_detail {
+inline std::atomic<int> runtimeLevel{LOG_MIN_LEVEL};
+} // namespace logger_detail
+
+/**
+ * @brief Indique si un message de ce niveau serait écrit.
+ */
+inline bool logEnabled(LogLevel level) {
+    return static_cast<int>(level) >= logger_detail::runtimeLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Choisit le niveau minimal à l'exécution (sans effet en dessous de `LOG_MIN_LEVEL`).
+ */
+void setLogLevel(LogLevel level);
+
+/**
+ * @brief Dépose une ligne déjà formatée dans la file du journal.
+ */
+void logPush(LogLevel level, const LogLine& line);
+
+/**
+ * @brief Formate les morceaux puis dépose le message ; appelée par les macros LOG_*.
+ */
+template <typename... Parts>
+void logFormat(LogLevel level, const Parts&... parts) {
+    LogLine line;
+    (line.append(parts), ...);
+    logPush(level, line);
+}
+
+/**
+ * @brief Attend que tous les messages déjà déposés aient été écrits.
+ */
+void flushLogs();
+
+/**
+ * @brief Journalise un message de niveau Info.
+ */
 void log(const std::string& message);
 
-#endif // LOGGER_HPP
\ No newline at end of file
+#define LOG_AT(level, ...)                                                     \
+    do {                                                                       \
+        if constexpr (static_cast<int>(level) >= LOG_MIN_LEVEL) {              \
+            if (logEnabled(level)) logFormat(level, __VA_ARGS__);              \
+        }                                                                      \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+#endif // LOGGER_HPP
@@ -1,5 +1,6 @@
 #include "MSTFactory.hpp"
 #include "Graph.hpp"
+#include "Cancellation.hpp"
 #include <algorithm>
 #include <vector>
 #include <tuple>
@@ -7,7 +8,8 @@
 #include <limits>
 
 // Prim's Algorithm Solver
-Graph PrimSolver::solveMST(Graph& graph) {
+Graph PrimSolver::solveMST(Graph& graph, CancellationToken* token) {
+    CancellationCheckpoint checkpoint(token);
     int V = graph.getNumVertices();
     Graph mst(V);
 
@@ -19,6 +21,7 @@ Graph PrimSolver::solveMST(Graph& graph) {
 
     key[0] = 0;
     pq.push({0, 0});
+    size_t added = 0; // Vertices already in the tree
 
     while (!pq.empty()) {
         int u = pq.top().second;
@@ -27,6 +30,7 @@ Graph PrimSolver::solveMST(Graph& graph) {
         if (inMST[u]) continue;
 
         inMST[u] = true;
+        checkpoint.step(++added, V);
 
         for (const auto& [v, weight] : graph.getAdjList()[u]) {
             if (!inMST[v] && weight < key[v]) {
@@ -53,11 +57,16 @@ Graph PrimSolver::solveMST(Graph& graph) {
 }
 
 // Kruskal's Algorithm Solver
-Graph KruskalSolver::solveMST(Graph& graph) {
+Graph KruskalSolver::solveMST(Graph& graph, CancellationToken* token) {
+    CancellationCheckpoint checkpoint(token);
     Graph mst(graph.getNumVertices());
     std::vector<std::tuple<int, int, int>> edges;
 
+    // Progress counts the vertices whose edges are collected, then the edges scanned.
+    const size_t V = static_cast<size_t>(graph.getNumVertices());
+    const size_t collectTotal = V + graph.getNumEdges();
     for (int u = 0; u < graph.getNumVertices(); ++u) {
+        checkpoint.step(static_cast<size_t>(u) + 1, collectTotal);
         for (const auto& [v, weight] : graph.getAdjList()[u]) {
             if (u < v) {
                 edges.emplace_back(weight, u, v);
@@ -65,11 +74,16 @@ Graph KruskalSolver::solveMST(Graph& graph) {
         }
     }
 
+    // The sort has no checkpoint: the token is checked before and after it.
+    checkpoint.check(V, V + edges.size());
     std::sort(edges.begin(), edges.end());
+    checkpoint.check(V, V + edges.size());
     UnionFind uf(graph.getNumVertices());
 
     int edgeCount = 0;
+    size_t scanned = 0; // Edges already considered, in increasing weight order
     for (const auto& [weight, u, v] : edges) {
+        checkpoint.step(V + ++scanned, V + edges.size());
         if (uf.unionSets(u, v)) {
             mst.add_edge(u, v, weight);
             edgeCount++;
@@ -84,7 +98,8 @@ Graph KruskalSolver::solveMST(Graph& graph) {
 }
 
 // Borůvka's Algorithm Solver
-Graph BoruvkaSolver::solveMST(Graph& graph) {
+Graph BoruvkaSolver::solveMST(Graph& graph, CancellationToken* token) {
+    CancellationCheckpoint checkpoint(token);
     int V = graph.getNumVertices();
     Graph mst(V);
 
@@ -104,6 +119,7 @@ Graph BoruvkaSolver::solveMST(Graph& graph) {
 
         // Find the cheapest edges connecting each component
         for (int u = 0; u < V; ++u) {
+            checkpoint.step(static_cast<size_t>(V - numComponents), static_cast<size_t>(V - 1));
             for (const auto& [v, weight] : graph.getAdjList()[u]) {
                 int compU = uf.find(u);
                 int compV = uf.find(v);
@@ -152,11 +168,16 @@ Graph BoruvkaSolver::solveMST(Graph& graph) {
 }
 
 // Tarjan's Algorithm Solver
-Graph TarjanSolver::solveMST(Graph& graph) {
+Graph TarjanSolver::solveMST(Graph& graph, CancellationToken* token) {
+    CancellationCheckpoint checkpoint(token);
     Graph mst(graph.getNumVertices());
     std::vector<std::tuple<int, int, int>> edges;
 
+    // Progress counts the vertices whose edges are collected, then the edges scanned.
+    const size_t V = static_cast<size_t>(graph.getNumVertices());
+    const size_t collectTotal = V + graph.getNumEdges();
     for (int u = 0; u < graph.getNumVertices(); ++u) {
+        checkpoint.step(static_cast<size_t>(u) + 1, collectTotal);
         for (const auto& [v, weight] : graph.getAdjList()[u]) {
             if (u < v) {
                 edges.emplace_back(weight, u, v);
@@ -164,11 +185,16 @@ Graph TarjanSolver::solveMST(Graph& graph) {
         }
     }
 
+    // The sort has no checkpoint: the token is checked before and after it.
+    checkpoint.check(V, V + edges.size());
     std::sort(edges.begin(), edges.end());
+    checkpoint.check(V, V + edges.size());
     UnionFind uf(graph.getNumVertices());
 
     int edgeCount = 0;
+    size_t scanned = 0; // Edges already considered, in increasing weight order
     for (const auto& [weight, u, v] : edges) {
+        checkpoint.step(V + ++scanned, V + edges.size());
         if (uf.unionSets(u, v)) {
             mst.add_edge(u, v, weight);
             edgeCount++;
@@ -183,7 +209,8 @@ Graph TarjanSolver::solveMST(Graph& graph) {
 }
 
 // Integer MST Solver
-Graph IntegerMSTSolver::solveMST(Graph& graph) {
+Graph IntegerMSTSolver::solveMST(Graph& graph, CancellationToken* token) {
+    CancellationCheckpoint checkpoint(token);
     int V = graph.getNumVertices();
     Graph mst(V);
 
@@ -195,6 +222,7 @@ Graph IntegerMSTSolver::solveMST(Graph& graph) {
 
     key[0] = 0;
     pq.push({0, 0});
+    size_t added = 0; // Vertices already in the tree
 
     int edgeCount = 0;
     while (!pq.empty()) {
@@ -203,6 +231,7 @@ Graph IntegerMSTSolver::solveMST(Graph& graph) {
 
         if (inMST[u]) continue;
         inMST[u] = true;
+        checkpoint.step(++added, V);
 
         for (const auto& [v, weight] : graph.getAdjList()[u]) {
             if (!inMST[v] && weight < key[v]) {
@@ -2,6 +2,7 @@
 #define MSTFACTORY_HPP
 
 class Graph;
+class CancellationToken;
 #include <vector>
 
 
@@ -11,8 +12,11 @@ public:
     virtual ~MSTFactory() = default;
     /*
      * Pure virtual function to solve the MST problem. This method must be implemented by all derived classes.
+     * With a `token`, the main loops poll it at checkpoints (throwing OperationCancelled once it is
+     * cancelled, DeadlineExceeded once its deadline has passed) and report their progress through
+     * it; see Cancellation.hpp.
      */
-    virtual Graph solveMST(Graph& graph) = 0;
+    virtual Graph solveMST(Graph& graph, CancellationToken* token = nullptr) = 0;
 };
 
 /*
@@ -23,7 +27,7 @@ public:
  */
 class PrimSolver : public MSTFactory {
 public:
-    Graph solveMST(Graph& graph) override;
+    Graph solveMST(Graph& graph, CancellationToken* token = nullptr) override;
 };
 
 /*
@@ -34,7 +38,7 @@ public:
  */
 class KruskalSolver : public MSTFactory {
 public:
-    Graph solveMST(Graph& graph) override;
+    Graph solveMST(Graph& graph, CancellationToken* token = nullptr) override;
 };
 
 /*
@@ -45,7 +49,7 @@ public:
  */
 class BoruvkaSolver : public MSTFactory {
 public:
-    Graph solveMST(Graph& graph) override;
+    Graph solveMST(Graph& graph, CancellationToken* token = nullptr) override;
 };
 
 /*
@@ -56,7 +60,7 @@ public:
  */
 class TarjanSolver : public MSTFactory {
 public:
-    Graph solveMST(Graph& graph) override;
+    Graph solveMST(Graph& graph, CancellationToken* token = nullptr) override;
 };
 
 /*
@@ -66,7 +70,7 @@ public:
  */
 class IntegerMSTSolver : public MSTFactory {
 public:
-    Graph solveMST(Graph& graph) override;
+    Graph solveMST(Graph& graph, CancellationToken* token = nullptr) override;
 };
 
 
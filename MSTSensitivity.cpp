@@ -0,0 +1,150 @@
+#include "MSTSensitivity.hpp"
+#include "Graph.hpp"
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// Roots the tree at vertex 0 and computes the min replacement of every tree edge.
+MSTSensitivity::MSTSensitivity(const Graph& graph, const Graph& mst)
+    : n(static_cast<int>(mst.adjList.size())), levels(1),
+      parent(n, -1), parentWeight(n, 0), depth(n, 0),
+      minReplacement(n, std::numeric_limits<int>::max()) {
+    while ((1 << levels) < n) ++levels;
+
+    // Iterative BFS so that deep trees (paths) do not overflow the stack.
+    std::vector<bool> visited(n, false);
+    std::vector<int> order;
+    order.reserve(n);
+    if (n > 0) {
+        visited[0] = true;
+        order.push_back(0);
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        int u = order[i];
+        for (const auto& [v, weight] : mst.adjList[u]) {
+            if (!visited[v]) {
+                visited[v] = true;
+                parent[v] = u;
+                parentWeight[v] = weight;
+                depth[v] = depth[u] + 1;
+                order.push_back(v);
+            }
+        }
+    }
+    buildLifting();
+
+    // Non-tree edges sorted by weight: the first one covering a tree edge is its min replacement.
+    std::vector<std::tuple<int, int, int>> nonTreeEdges;
+    for (int u = 0; u < n; ++u) {
+        for (const auto& [v, weight] : graph.adjList[u]) {
+            if (u < v && !isTreeEdge(u, v)) {
+                nonTreeEdges.emplace_back(weight, u, v);
+            }
+        }
+    }
+    std::sort(nonTreeEdges.begin(), nonTreeEdges.end());
+
+    // jump[v] leads to the deepest ancestor of v (v included) whose parent edge is still unassigned.
+    std::vector<int> jump(n);
+    for (int v = 0; v < n; ++v) jump[v] = v;
+    auto find = [&](int v) {
+        int root = v;
+        while (jump[root] != root) root = jump[root];
+        while (jump[v] != root) {
+            int next = jump[v];
+            jump[v] = root;
+            v = next;
+        }
+        return root;
+    };
+
+    for (const auto& [weight, u, v] : nonTreeEdges) {
+        int a = find(u), b = find(v);
+        while (a != b) {
+            if (depth[a] < depth[b]) std::swap(a, b);
+            minReplacement[a] = weight;
+            jump[a] = parent[a];
+            a = find(a);
+        }
+    }
+}
+
+bool MSTSensitivity::isTreeEdge(int u, int v) const {
+    return childOf(u, v) != -1;
+}
+
+int MSTSensitivity::getMinReplacement(int u, int v) const {
+    int child = childOf(u, v);
+    return child == -1 ? std::numeric_limits<int>::max() : minReplacement[child];
+}
+
+// Lifts both endpoints to their lowest common ancestor, keeping the heaviest edge crossed.
+int MSTSensitivity::getMaxOnPath(int u, int v) {
+    if (liftingStale) buildLifting();
+
+    int result = std::numeric_limits<int>::min();
+    if (depth[u] < depth[v]) std::swap(u, v);
+    for (int k = levels - 1; k >= 0; --k) {
+        if (depth[u] - (1 << k) >= depth[v]) {
+            result = std::max(result, upMax[k][u]);
+            u = up[k][u];
+        }
+    }
+    if (u == v) return result;
+    for (int k = levels - 1; k >= 0; --k) {
+        if (up[k][u] != up[k][v]) {
+            result = std::max({result, upMax[k][u], upMax[k][v]});
+            u = up[k][u];
+            v = up[k][v];
+        }
+    }
+    return std::max({result, parentWeight[u], parentWeight[v]});
+}
+
+std::pair<int, int> MSTSensitivity::getRange(int u, int v) {
+    if (isTreeEdge(u, v)) {
+        return {std::numeric_limits<int>::min(), getMinReplacement(u, v)};
+    }
+    return {getMaxOnPath(u, v), std::numeric_limits<int>::max()};
+}
+
+// Min replacements only depend on non-tree edges, so only the lifting tables become stale.
+void MSTSensitivity::updateTreeEdge(int u, int v, int weight) {
+    int child = childOf(u, v);
+    if (child == -1) return;
+    parentWeight[child] = weight;
+    liftingStale = true;
+}
+
+// Walks the tree path between `u` and `v`, lowering the min replacement of each edge on it.
+void MSTSensitivity::relaxNonTreeEdge(int u, int v, int weight) {
+    while (u != v) {
+        if (depth[u] < depth[v]) std::swap(u, v);
+        minReplacement[u] = std::min(minReplacement[u], weight);
+        u = parent[u];
+    }
+}
+
+int MSTSensitivity::childOf(int u, int v) const {
+    if (u < 0 || v < 0 || u >= n || v >= n) return -1;
+    if (parent[u] == v) return u;
+    if (parent[v] == u) return v;
+    return -1;
+}
+
+void MSTSensitivity::buildLifting() {
+    up.assign(levels, std::vector<int>(n));
+    upMax.assign(levels, std::vector<int>(n));
+    for (int v = 0; v < n; ++v) {
+        up[0][v] = parent[v] == -1 ? v : parent[v];
+        upMax[0][v] = parent[v] == -1 ? std::numeric_limits<int>::min() : parentWeight[v];
+    }
+    for (int k = 1; k < levels; ++k) {
+        for (int v = 0; v < n; ++v) {
+            up[k][v] = up[k - 1][up[k - 1][v]];
+            upMax[k][v] = std::max(upMax[k - 1][v], upMax[k - 1][up[k - 1][v]]);
+        }
+    }
+    liftingStale = false;
+}
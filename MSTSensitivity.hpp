@@ -0,0 +1,60 @@
+#ifndef MSTSENSITIVITY_HPP
+#define MSTSENSITIVITY_HPP
+
+#include <vector>
+#include <utility>
+
+class Graph;
+
+/*
+ * MSTSensitivity:
+ * Stores, for a spanning tree of a graph, the range of weights over which every edge can move
+ * without changing the tree that is optimal.
+ *  - A tree edge (u, v) stays in the MST as long as its weight is not larger than the lightest
+ *    non-tree edge whose cycle goes through (u, v) (its "min replacement").
+ *  - A non-tree edge (u, v) stays out of the MST as long as its weight is not smaller than the
+ *    heaviest tree edge on the tree path between u and v ("max on path").
+ *
+ * The tree is rooted at vertex 0. Max-on-path queries use binary lifting (O(log V) per query) and
+ * min replacements are computed for all tree edges at once by scanning the non-tree edges in
+ * increasing weight order and skipping already assigned tree edges with a union-find style jump
+ * pointer, so `build` runs in O(E log E + V log V).
+ */
+class MSTSensitivity {
+public:
+    // Builds the path structures for `mst`, which must be a spanning tree of `graph`.
+    MSTSensitivity(const Graph& graph, const Graph& mst);
+
+    // Returns true if (u, v) is an edge of the tree.
+    bool isTreeEdge(int u, int v) const;
+    // Weight of the lightest non-tree edge that can replace the tree edge (u, v) (INT_MAX for a bridge).
+    int getMinReplacement(int u, int v) const;
+    // Weight of the heaviest tree edge on the path between `u` and `v` (INT_MIN if u == v).
+    int getMaxOnPath(int u, int v);
+    // Returns the [low, high] range of weights for which the current MST stays optimal for edge (u, v).
+    std::pair<int, int> getRange(int u, int v);
+
+    // Records a new weight for the tree edge (u, v) that stayed within its range.
+    void updateTreeEdge(int u, int v, int weight);
+    // Records a non-tree edge (u, v) of weight `weight` that is new or got lighter,
+    // lowering the min replacement of every tree edge on its path.
+    void relaxNonTreeEdge(int u, int v, int weight);
+
+private:
+    int n;
+    int levels;
+    std::vector<int> parent;          // Parent of each vertex in the rooted tree (-1 for the root).
+    std::vector<int> parentWeight;    // Weight of the edge to the parent.
+    std::vector<int> depth;           // Depth of each vertex in the rooted tree.
+    std::vector<int> minReplacement;  // Min replacement of the edge (v, parent[v]), indexed by v.
+    std::vector<std::vector<int>> up;     // up[k][v]: 2^k-th ancestor of v.
+    std::vector<std::vector<int>> upMax;  // upMax[k][v]: heaviest edge on the 2^k edges above v.
+    bool liftingStale = false;            // True when a tree weight changed since the tables were built.
+
+    // Returns the child endpoint of the tree edge (u, v), or -1 if (u, v) is not a tree edge.
+    int childOf(int u, int v) const;
+    // (Re)builds the binary lifting tables from `parent` and `parentWeight`.
+    void buildLifting();
+};
+
+#endif // MSTSENSITIVITY_HPP
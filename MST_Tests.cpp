@@ -1,7 +1,12 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "../../src/Model_Test/doctest.h"
+#include "../../src/Model/Cancellation.hpp"
 #include "../../src/Model/Graph.hpp"
 #include "../../src/Model/MSTFactory.hpp"
+#include "../../src/Model/OutputBuffer.hpp"
+#include <chrono>
+#include <cstring>
+#include <memory>
 
 MSTFactory* solverPrim = new PrimSolver();
 MSTFactory* solverKruskal = new KruskalSolver();
@@ -267,6 +272,347 @@ TEST_CASE("MST: Total Weight Calculation") {
 
 }
 
+TEST_CASE("MST: Edge Sensitivity Ranges") {
+    Graph graph(5);
+    graph.add_edge(0, 1, 2);
+    graph.add_edge(1, 2, 3);
+    graph.add_edge(0, 3, 6);
+    graph.add_edge(1, 4, 5);
+    graph.add_edge(3, 1, 8);
+    graph.add_edge(4, 2, 7);
+
+    // Tree edges: the weight can grow up to the lightest non-tree edge of their cycles.
+    CHECK(graph.getEdgeSensitivity_MST(0, 1).second == 8);
+    CHECK(graph.getEdgeSensitivity_MST(0, 3).second == 8);
+    CHECK(graph.getEdgeSensitivity_MST(1, 2).second == 7);
+    CHECK(graph.getEdgeSensitivity_MST(4, 1).second == 7);
+
+    // Non-tree edges: the weight can drop down to the heaviest tree edge on their path.
+    CHECK(graph.getEdgeSensitivity_MST(3, 1).first == 6);
+    CHECK(graph.getEdgeSensitivity_MST(4, 2).first == 5);
+}
+
+TEST_CASE("MST: Weight Updates Inside The Sensitivity Range Skip The Solve") {
+    Graph graph(5);
+    graph.add_edge(0, 1, 2);
+    graph.add_edge(1, 2, 3);
+    graph.add_edge(0, 3, 6);
+    graph.add_edge(1, 4, 5);
+    graph.add_edge(3, 1, 8);
+    graph.add_edge(4, 2, 7);
+    graph.Solve();
+    CHECK(graph.isMSTUpToDate());
+
+    // Tree edge made heavier but still lighter than its replacement.
+    graph.changeEdgeWeight(0, 3, 7);
+    CHECK(graph.isMSTUpToDate());
+    CHECK(graph.getTotalWeight_MST() == 17);
+
+    // Non-tree edge made lighter but still heavier than its tree path, then a new heavy edge.
+    graph.add_edge(4, 2, 6);
+    graph.add_edge(3, 4, 9);
+    CHECK(graph.isMSTUpToDate());
+
+    // The lowered non-tree edge is now the replacement of (1, 4): 7 is out of range.
+    CHECK(graph.getEdgeSensitivity_MST(1, 4).second == 6);
+    graph.changeEdgeWeight(1, 4, 7);
+    CHECK_FALSE(graph.isMSTUpToDate());
+
+    Graph expectedMST(5);
+    expectedMST.add_edge(0, 1, 2);
+    expectedMST.add_edge(1, 2, 3);
+    expectedMST.add_edge(0, 3, 7);
+    expectedMST.add_edge(4, 2, 6);
+    graph.Solve();
+    CHECK(graph.mst->compareGraphs(expectedMST));
+
+    // Removing a non-tree edge keeps the MST, removing a tree edge does not.
+    graph.remove_edge(3, 4);
+    CHECK(graph.isMSTUpToDate());
+    graph.remove_edge(0, 1);
+    CHECK_FALSE(graph.isMSTUpToDate());
+}
+
+TEST_CASE("MST: Patched MST Matches A Full Solve After Random Updates") {
+    const int n = 12;
+    Graph graph(n);
+    unsigned int seed = 12345;
+    auto next = [&seed](unsigned int mod) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<int>((seed >> 16) % mod);
+    };
+    for (int v = 1; v < n; ++v) graph.add_edge(v, next(v), 1 + next(50));
+    for (int i = 0; i < 20; ++i) graph.add_edge(next(n), next(n), 1 + next(50));
+
+    for (int step = 0; step < 300; ++step) {
+        graph.Solve();
+        int u = next(n), v = next(n), w = 1 + next(50);
+        if (step % 2 == 0) graph.add_edge(u, v, w);
+        else graph.changeEdgeWeight(u, v, w);
+
+        bool patched = graph.isMSTUpToDate();
+        double weight = patched ? graph.getTotalWeight_MST() : 0;
+        Graph fresh = solverKruskal->solveMST(graph);
+        if (patched) {
+            CHECK(weight == fresh.getTotalWeight());
+        }
+        graph.Solve();
+        CHECK(graph.getTotalWeight_MST() == fresh.getTotalWeight());
+    }
+}
+
+TEST_CASE("Graph: Selective And Memoized Analysis") {
+    Graph graph(5);
+    graph.add_edge(0, 1, 2);
+    graph.add_edge(1, 2, 3);
+    graph.add_edge(0, 3, 6);
+    graph.add_edge(1, 4, 5);
+    graph.add_edge(3, 1, 8);
+    graph.add_edge(4, 2, 7);
+
+    CHECK(parseAnalysisMetric("weight") == ANALYSIS_WEIGHT);
+    CHECK(parseAnalysisMetric("all") == ANALYSIS_ALL);
+    CHECK(parseAnalysisMetric("unknown") == 0);
+
+    // Only the requested section is produced.
+    std::string weightOnly = graph.Analysis(ANALYSIS_WEIGHT);
+    CHECK(weightOnly.find("Total MST weight: 16") != std::string::npos);
+    CHECK(weightOnly.find("Graph Representation") == std::string::npos);
+    CHECK(weightOnly.find("Average distance") == std::string::npos);
+
+    std::string full = graph.Analysis();
+    CHECK(full.find("Graph Representation") != std::string::npos);
+    CHECK(full.find("MST Representation") != std::string::npos);
+    CHECK(full.find("Lightest edge: Vertex 0 <----(2)----> Vertex 1") != std::string::npos);
+
+    // Sections are reused until the MST changes.
+    const std::string* cached = &graph.getAnalysisSection(ANALYSIS_WEIGHT);
+    CHECK(&graph.getAnalysisSection(ANALYSIS_WEIGHT) == cached);
+    graph.changeEdgeWeight(0, 1, 1);
+    CHECK(graph.getAnalysisSection(ANALYSIS_WEIGHT).find("Total MST weight: 15") != std::string::npos);
+}
+
+TEST_CASE("OutputBuffer: Chunked Formatting And Draining") {
+    OutputBuffer out;
+    out << "weight " << 42 << ' ' << 2.5 << '\n';
+    out.pad(3) << "x";
+    CHECK(out.str() == "weight 42 2.500000\n   x");
+
+    // Data spanning several chunks is kept in order and can be consumed partially.
+    out.clear();
+    std::string big(OutputBuffer::CHUNK_SIZE * 2 + 10, 'a');
+    big[OutputBuffer::CHUNK_SIZE] = 'b';
+    out << big;
+    CHECK(out.size() == big.size());
+    out.consume(OutputBuffer::CHUNK_SIZE);
+    CHECK(out.str() == big.substr(OutputBuffer::CHUNK_SIZE));
+
+    // The drain callback keeps the buffered size bounded.
+    size_t drained = 0;
+    OutputBuffer bounded;
+    bounded.setDrain(100, [&drained](OutputBuffer& buffer) {
+        drained += buffer.size();
+        buffer.clear();
+    });
+    for (int i = 0; i < 1000; ++i) bounded << "0123456789";
+    CHECK(bounded.size() < 100);
+    CHECK(drained + bounded.size() == 10000);
+}
+
+TEST_CASE("Graph: Paged Graph Display") {
+    Graph graph(4);
+    graph.add_edge(0, 1, 10);
+    graph.add_edge(0, 2, 5);
+    graph.add_edge(1, 2, 7);
+    graph.add_edge(2, 3, 3);
+
+    // The full display keeps its format.
+    std::string full = graph.displayGraph();
+    CHECK(full.find("Vertices in the graph: 0 1 2 3 ") != std::string::npos);
+    CHECK(full.find("Vertex 2 <----(3)----> Vertex 3") != std::string::npos);
+
+    OutputBuffer page;
+    graph.writeGraph(page, 1, 2);
+    std::string text = page.str();
+    CHECK(text.find("(2 of 4 shown)") != std::string::npos);
+    CHECK(text.find("Vertex 0 <----(10)----> Vertex 1") == std::string::npos);
+    CHECK(text.find("Vertex 0 <----(5)----> Vertex 2") != std::string::npos);
+    CHECK(text.find("Vertex 1 <----(7)----> Vertex 2") != std::string::npos);
+    CHECK(text.find("Vertex 2 <----(3)----> Vertex 3") == std::string::npos);
+}
+
+TEST_CASE("Graph: Binary Analysis And Edge Frames") {
+    Graph graph(4);
+    graph.add_edge(0, 1, 10);
+    graph.add_edge(0, 2, 5);
+    graph.add_edge(1, 2, 7);
+    graph.add_edge(2, 3, 3);
+
+    auto u32 = [](const std::string& bytes, size_t at) {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) value = (value << 8) | static_cast<unsigned char>(bytes[at + i]);
+        return value;
+    };
+
+    // Header, section mask, then the weight (f64) and the heaviest and lightest edges (3 x i32 each).
+    OutputBuffer out;
+    graph.writeAnalysisBinary(out, ANALYSIS_WEIGHT | ANALYSIS_MAX_EDGE | ANALYSIS_MIN_EDGE);
+    std::string frame = out.str();
+    REQUIRE(frame.size() == FRAME_HEADER_SIZE + 36);
+    CHECK(u32(frame, 0) == 36);
+    CHECK(frame[4] == FRAME_ANALYSIS);
+    CHECK(u32(frame, 5) == (ANALYSIS_WEIGHT | ANALYSIS_MAX_EDGE | ANALYSIS_MIN_EDGE));
+    double weight;
+    uint64_t bits = static_cast<uint64_t>(u32(frame, 13)) << 32 | u32(frame, 9);
+    std::memcpy(&weight, &bits, sizeof(weight));
+    CHECK(weight == 15.0);
+    CHECK(u32(frame, 25) == 7);
+    CHECK(u32(frame, 37) == 3);
+
+    // A page of edges: source, offset, total, count, then (u, v, w) triples.
+    out.clear();
+    graph.writeEdgesBinary(out, false, 1, 2);
+    frame = out.str();
+    REQUIRE(frame.size() == FRAME_HEADER_SIZE + 13 + 24);
+    CHECK(frame[4] == FRAME_EDGES);
+    CHECK(frame[5] == 0);
+    CHECK(u32(frame, 6) == 1);
+    CHECK(u32(frame, 10) == 4);
+    CHECK(u32(frame, 14) == 2);
+    CHECK(u32(frame, 18) == 0);
+    CHECK(u32(frame, 22) == 2);
+    CHECK(u32(frame, 26) == 5);
+
+}
+
+TEST_CASE("Graph: Self-Loops Are Ignored And Frames Stay In Sync") {
+    Graph graph(4);
+    graph.add_edge(0, 1, 10);
+    graph.add_edge(2, 2, 7); // Ignored: no edge listing could show it.
+    graph.add_edge(1, 2, 4);
+    graph.add_edge(2, 3, 3);
+    CHECK(graph.getNumEdges() == 3);
+    CHECK(graph.getTotalWeight() == 17);
+
+    auto u32 = [](const std::string& bytes, size_t at) {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) value = (value << 8) | static_cast<unsigned char>(bytes[at + i]);
+        return value;
+    };
+
+    // The declared length of each frame is the number of bytes that follow its header.
+    OutputBuffer out;
+    graph.writeEdgesBinary(out, false);
+    std::string frame = out.str();
+    CHECK(u32(frame, 0) == frame.size() - FRAME_HEADER_SIZE);
+    CHECK(u32(frame, 10) == 3);
+
+    out.clear();
+    graph.writeAnalysisBinary(out);
+    frame = out.str();
+    CHECK(u32(frame, 0) == frame.size() - FRAME_HEADER_SIZE);
+    CHECK(graph.mst->getNumEdges() == 3);
+}
+
+TEST_CASE("MST: Cancellation And Progress") {
+    // A path plus chords, large enough for the solvers to reach a checkpoint.
+    const int V = 5000;
+    Graph graph(V);
+    for (int v = 1; v < V; ++v) graph.add_edge(v - 1, v, 1 + (v * 7) % 13);
+    for (int v = 0; v + 3 < V; v += 2) graph.add_edge(v, v + 3, 1 + (v * 5) % 17);
+
+    MSTFactory* solvers[] = {solverPrim, solverKruskal, solverBoruvka, solverTarjan, solverIntegerMST};
+    CancellationToken cancelled;
+    cancelled.cancel();
+    for (MSTFactory* solver : solvers) {
+        CHECK_THROWS_AS(solver->solveMST(graph, &cancelled), OperationCancelled);
+    }
+
+    // A cancelled solve leaves no MST behind; an uncancelled one is the usual MST.
+    CHECK_THROWS_AS(graph.Solve(&cancelled), OperationCancelled);
+    CHECK_FALSE(graph.isMSTUpToDate());
+    CancellationToken token;
+    graph.Solve(&token);
+    CHECK(graph.isMSTUpToDate());
+    CHECK(token.progress() == 1.0);
+    Graph expected = solverKruskal->solveMST(graph);
+    CHECK(graph.mst->getTotalWeight() == expected.getTotalWeight());
+}
+
+TEST_CASE("MST: Solve Deadlines And Parent Tokens") {
+    const int V = 5000;
+    Graph graph(V);
+    for (int v = 1; v < V; ++v) graph.add_edge(v - 1, v, 1 + (v * 11) % 19);
+
+    // A deadline already passed stops every solver at its first checkpoint.
+    MSTFactory* solvers[] = {solverPrim, solverKruskal, solverBoruvka, solverTarjan, solverIntegerMST};
+    CancellationToken expired;
+    expired.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+    for (MSTFactory* solver : solvers) {
+        CHECK_THROWS_AS(solver->solveMST(graph, &expired), DeadlineExceeded);
+    }
+    expired.clearDeadline();
+    CHECK(solverPrim->solveMST(graph, &expired).getTotalWeight() == solverKruskal->solveMST(graph).getTotalWeight());
+
+    // Cancelling a parent cancels its children, but a parent's deadline does not apply to them.
+    auto parent = std::make_shared<CancellationToken>();
+    CancellationToken child(parent);
+    parent->setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+    CHECK_NOTHROW(graph.Solve(&child));
+    graph.add_edge(0, V - 1, 1);
+    parent->cancel();
+    CHECK(child.isCancelled());
+    CHECK_THROWS_AS(graph.Solve(&child), OperationCancelled);
+    CHECK_FALSE(graph.isMSTUpToDate());
+}
+
+TEST_CASE("MST: Sorting Solvers Check The Token Around The Sort") {
+    // Too small for a periodic checkpoint: only the checks around the sort can stop the solve.
+    Graph graph(4);
+    graph.add_edge(0, 1, 3);
+    graph.add_edge(1, 2, 1);
+    graph.add_edge(2, 3, 2);
+    CancellationToken cancelled;
+    cancelled.cancel();
+    CHECK_THROWS_AS(solverKruskal->solveMST(graph, &cancelled), OperationCancelled);
+    CHECK_THROWS_AS(solverTarjan->solveMST(graph, &cancelled), OperationCancelled);
+    CancellationToken token;
+    CHECK(solverTarjan->solveMST(graph, &token).getTotalWeight() == 6);
+}
+
+TEST_CASE("Graph: Writers Solve A Stale MST Under The Caller's Token") {
+    Graph graph(4);
+    graph._algorithmChoice = "kruskal";
+    graph.add_edge(0, 1, 3);
+    graph.add_edge(1, 2, 1);
+    graph.add_edge(2, 3, 2);
+    CancellationToken cancelled;
+    cancelled.cancel();
+
+    // Nothing is written when the solve is interrupted.
+    OutputBuffer out;
+    CHECK_THROWS_AS(graph.writeMST(out, 0, 1, &cancelled), OperationCancelled);
+    CHECK_THROWS_AS(graph.writeEdgesBinary(out, true, 0, 1, &cancelled), OperationCancelled);
+    CHECK_THROWS_AS(graph.writeAnalysis(out, ANALYSIS_WEIGHT, &cancelled), OperationCancelled);
+    CHECK(out.str() == "\n");
+    out.clear();
+    CHECK_THROWS_AS(graph.getAnalysisSection(ANALYSIS_WEIGHT, &cancelled), OperationCancelled);
+    CHECK_THROWS_AS(graph.getBinarySection(ANALYSIS_MIN_EDGE, &cancelled), OperationCancelled);
+    CHECK_THROWS_AS(graph.getAvailableSections(ANALYSIS_ALL, &cancelled), OperationCancelled);
+    CHECK_FALSE(graph.isMSTUpToDate());
+
+    // The graph itself needs no MST.
+    CHECK_NOTHROW(graph.writeEdgesBinary(out, false, 0, 1, &cancelled));
+    CHECK(graph.getAvailableSections(ANALYSIS_GRAPH, &cancelled) == ANALYSIS_GRAPH);
+
+    // Once solved, the token is not consulted again.
+    graph.Solve();
+    out.clear();
+    CHECK_NOTHROW(graph.writeMST(out, 0, 3, &cancelled));
+    CHECK(out.str().find("Vertex 1 <----(1)----> Vertex 2") != std::string::npos);
+    CHECK(graph.getAnalysisSection(ANALYSIS_WEIGHT, &cancelled).find("Total MST weight: 6") != std::string::npos);
+}
+
 // TEST_CASE("BIG TESTS") {
 // // --- Test graph with 3 vertices ---
 // Graph graph3(3);
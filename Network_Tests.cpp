@@ -0,0 +1,1136 @@
+#include "../../src/Model_Test/doctest.h"
+#include "../../src/Model/Graph.hpp"
+#include "../../src/Model/OutputBuffer.hpp"
+#include "../../src/Network/ActiveObject.hpp"
+#include "../../src/Network/ChaseLevDeque.hpp"
+#include "../../src/Network/CpuAffinity.hpp"
+#include "../../src/Network/FairQueue.hpp"
+#include "../../src/Network/LeaderFollowers.hpp"
+#include "../../src/Network/Logger.hpp"
+#include "../../src/Network/Pipeline.hpp"
+#include "../../src/Network/Session.hpp"
+#include "../../src/Network/SolveJobs.hpp"
+#include "../../src/Network/SpscRing.hpp"
+#include "../../src/Network/UniqueTask.hpp"
+#include "../../src/Network/WorkerPool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+// Waits up to a few seconds for `done`, yielding to the pool's threads.
+template <typename Predicate>
+bool waitFor(Predicate done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void signalEvent(int fd) {
+    uint64_t one = 1;
+    REQUIRE(write(fd, &one, sizeof(one)) == sizeof(one));
+}
+} // namespace
+
+TEST_CASE("SolveJobs: Cancelled Jobs Free Their Slot") {
+    Graph g(4);
+    g.add_edge(0, 1, 1);
+    g.add_edge(1, 2, 2);
+    g.add_edge(2, 3, 3);
+
+    // The executor keeps the tasks without running them: every job stays queued.
+    std::vector<UniqueTask> queued;
+    SolveJobs jobs;
+    jobs.setExecutor([&queued](UniqueTask task, uint64_t) {
+        queued.push_back(std::move(task));
+        return true;
+    });
+
+    for (size_t i = 0; i < 3 * SolveJobs::MAX_JOBS; ++i) {
+        uint64_t id = jobs.start(g, ANALYSIS_ALL, false);
+        REQUIRE(id != 0);
+        CHECK(jobs.cancel(id));
+        CHECK_FALSE(jobs.cancel(id)); // Already forgotten.
+    }
+    CHECK(jobs.size() == 0);
+
+    // Unfetched jobs still count.
+    for (size_t i = 0; i < SolveJobs::MAX_JOBS; ++i) CHECK(jobs.start(g, ANALYSIS_ALL, false) != 0);
+    CHECK(jobs.start(g, ANALYSIS_ALL, false) == 0);
+
+    // The tasks of forgotten jobs still run, and stop without a result.
+    for (UniqueTask& task : queued) task();
+    CHECK(jobs.size() == SolveJobs::MAX_JOBS);
+    OutputBuffer out;
+    SolveJobs::Status status;
+    REQUIRE(jobs.status(1 + 3 * SolveJobs::MAX_JOBS, status));
+    CHECK(status.state == SolveJobs::State::Done);
+    CHECK(jobs.takeResult(1 + 3 * SolveJobs::MAX_JOBS, out));
+    CHECK(out.size() > 0);
+}
+
+TEST_CASE("Session: Superseded Jobs Free Their Slot") {
+    std::vector<UniqueTask> queued;
+    Session session(-1);
+    session.setJobExecutor([&queued](UniqueTask task, uint64_t) {
+        queued.push_back(std::move(task));
+        return true;
+    });
+    session.execute("create 3 0");
+    session.execute("add 0 1 1");
+    session.output.clear();
+
+    // Each `solve async` cancels the job still queued before it.
+    for (size_t i = 1; i <= 3 * SolveJobs::MAX_JOBS; ++i) {
+        session.execute("solve async");
+        std::string reply = session.output.str();
+        session.output.clear();
+        CHECK(reply.find("Job " + std::to_string(i) + " started.") != std::string::npos);
+        CHECK((reply.find("1 unfinished job(s) cancelled.") != std::string::npos) == (i > 1));
+    }
+    for (UniqueTask& task : queued) task();
+    session.execute("status " + std::to_string(3 * SolveJobs::MAX_JOBS));
+    CHECK(session.output.str() == "Job " + std::to_string(3 * SolveJobs::MAX_JOBS) + ": done.\n");
+    session.output.clear();
+    session.execute("status 1");
+    CHECK(session.output.str() == "Error: Unknown job 1.\n");
+}
+
+TEST_CASE("Session: Finished Jobs Keep Their Slot Until Fetched") {
+    Session session(-1); // No executor: jobs run on the spot.
+    session.execute("create 3 0");
+    session.execute("add 0 1 1");
+    for (size_t i = 0; i < SolveJobs::MAX_JOBS; ++i) session.execute("solve async");
+    session.output.clear();
+
+    session.execute("solve async");
+    CHECK(session.output.str().find("Error: Cannot start a job") == 0);
+    session.output.clear();
+    session.execute("result 1");
+    CHECK(session.output.size() > 0);
+    session.output.clear();
+    session.execute("solve async");
+    CHECK(session.output.str().find("Job " + std::to_string(SolveJobs::MAX_JOBS + 1) + " started.") == 0);
+}
+
+TEST_CASE("Session: Analysis On Demand Or Every N Changes") {
+    using Action = Session::Action;
+    Session session(-1); // Default: analyzed after every change.
+    CHECK(session.execute("create 4 0") == Action::Analyze);
+    CHECK(session.execute("add 0 1 1") == Action::Analyze);
+    CHECK(session.execute("help") == Action::None);
+    session.output.clear();
+    CHECK(session.execute("add 2 2 1") == Action::None); // Rejected: not a change.
+    CHECK(session.output.str() == "Error: Self-loops are not allowed.\n");
+
+    CHECK(session.execute("autoanalyze 0") == Action::None);
+    CHECK(session.execute("add 1 2 2") == Action::None);
+    CHECK(session.execute("remove 1 2") == Action::None);
+    CHECK(session.execute("analyze") == Action::Analyze);
+    CHECK(session.execute("analyze bogus") == Action::None); // Invalid metric: nothing to analyze.
+
+    CHECK(session.execute("autoanalyze 3") == Action::None);
+    CHECK(session.execute("add 1 2 2") == Action::None);
+    CHECK(session.execute("add 2 3 3") == Action::None);
+    CHECK(session.execute("add 0 3 4") == Action::Analyze);
+    CHECK(session.execute("add 0 2 5") == Action::None);
+    CHECK(session.execute("analyze") == Action::Analyze); // Restarts the count.
+    CHECK(session.execute("remove 0 2") == Action::None);
+    CHECK(session.execute("autoanalyze -1") == Action::None);
+
+    // resume() writes the requested analysis, here inline.
+    session.output.clear();
+    session.feed("analyze weight\n", 15);
+    CHECK(session.resume(1) == Session::Progress::Idle);
+    CHECK(session.output.str().find("Total MST weight: 6") != std::string::npos);
+    session.output.clear();
+    session.feed("analyze\n", 8);
+    CHECK(session.resume(1, 0) == Session::Progress::Analyze); // Above the inline cost: left to the caller.
+    CHECK(session.output.empty());
+}
+
+TEST_CASE("Session: A Page Of A Stale MST Is Written Like An Analysis") {
+    using Action = Session::Action;
+    Session session(-1, 0);
+    session.execute("create 3");
+    session.execute("add 0 1 4");
+    session.execute("add 1 2 5");
+
+    // The MST must be solved first: the page costs an analysis, and is left to the caller.
+    const std::string pages = "show graph\nshow mst 1\n";
+    session.feed(pages.data(), pages.size());
+    CHECK(session.nextCommandCost() == 3);
+    std::string command;
+    REQUIRE(session.nextCommand(command));
+    CHECK(session.nextCommandCost() == 3 + session.analysisCost());
+    REQUIRE(session.nextCommand(command));
+    session.output.clear();
+    CHECK(session.execute(command) == Action::Analyze);
+    CHECK(session.pagePending());
+    CHECK(session.output.empty());
+    session.writeAnalysis();
+    CHECK_FALSE(session.pagePending());
+    CHECK(session.output.str().find("Edges from index 1 (1 of 2 shown):") != std::string::npos);
+    CHECK(session.output.str().find("Vertex 1 <----(5)----> Vertex 2") != std::string::npos);
+    CHECK(session.output.str().find("Total MST weight") == std::string::npos);
+
+    // Up to date, the page is written right away.
+    session.output.clear();
+    CHECK(session.execute("show mst 0 1") == Action::None);
+    CHECK(session.output.str().find("Vertex 0 <----(4)----> Vertex 1") != std::string::npos);
+
+    // resume() hands it over like a large analysis, and a later command drops a page never written.
+    session.execute("add 0 2 1");
+    session.feed("show mst\n", 9);
+    CHECK(session.resume(1, 0) == Session::Progress::Analyze);
+    CHECK(session.pagePending());
+    session.execute("help");
+    CHECK_FALSE(session.pagePending());
+}
+
+TEST_CASE("Session: Pages Of The MST Are Solved Under The Session's Token") {
+    Session session(-1, 0);
+    session.execute("create 3");
+    session.execute("algo kruskal");
+    session.execute("add 0 1 4");
+    session.execute("add 1 2 5");
+    session.cancelComputations(); // The client left: nothing is solved for it any more.
+
+    session.output.clear();
+    REQUIRE(session.execute("show mst") == Session::Action::Analyze);
+    session.writeAnalysis();
+    CHECK(session.output.str() == "Error: Analysis cancelled.\n");
+    CHECK_FALSE(session.graph->isMSTUpToDate());
+    session.output.clear();
+    CHECK(session.execute("show graph 0 1") == Session::Action::None); // No MST needed.
+    CHECK(session.output.str().find("Vertex 0 <----(4)----> Vertex 1") != std::string::npos);
+}
+
+TEST_CASE("Session: An Overlong Command Closes The Session") {
+    Session session(-1);
+    std::string line(Session::MAX_LINE_LENGTH, 'x');
+    CHECK(session.feed(line.data(), line.size())); // At the limit: still a command.
+    CHECK_FALSE(session.hasCommand());
+    CHECK(session.feed("\ncreate 3 0\n", 12));
+    CHECK(session.feed(line.data(), line.size()));
+    CHECK_FALSE(session.feed("x", 1)); // One byte over: the line and all later input are dropped.
+    CHECK_FALSE(session.feed("help\n", 5));
+    CHECK(session.pendingInput() == Session::MAX_LINE_LENGTH + 12);
+
+    // The complete commands received before it still run, then the session closes.
+    CHECK(session.resume(2) == Session::Progress::Pending);
+    std::string reply = session.output.str();
+    CHECK(reply.find("Unknown command.") == 0);
+    CHECK(reply.find("Graph created with 3 vertices.") != std::string::npos);
+    session.output.clear();
+    CHECK(session.resume(2) == Session::Progress::Closed);
+    CHECK(session.output.str() ==
+          "Error: Command longer than " + std::to_string(Session::MAX_LINE_LENGTH) + " bytes. Closing the session.\n");
+    CHECK(session.pendingInput() == 0);
+    CHECK_FALSE(session.hasCommand());
+}
+
+TEST_CASE("WorkerPool: Admission Control Bounds The Queue") {
+    WorkerPool pool(1, 2);
+    std::atomic<bool> started{false}, release{false};
+    std::atomic<int> ran{0};
+    REQUIRE(pool.try_submit([&]() {
+        started = true;
+        while (!release) std::this_thread::yield();
+    }));
+    REQUIRE(waitFor([&]() { return started.load(); }));
+
+    // The only thread is busy: two tasks may wait, the third is refused.
+    CHECK(pool.try_submit(1, 1, [&]() { ++ran; }));
+    CHECK(pool.try_submit(2, 1, [&]() { ++ran; }));
+    CHECK_FALSE(pool.try_submit(3, 1, [&]() { ++ran; }));
+    CHECK(pool.pending() == 2);
+    // The follow-up of an admitted task is never refused.
+    CHECK(pool.submit(1, 1, [&]() { ++ran; }));
+    CHECK(pool.pending() == 3);
+
+    // A failing task does not take its thread down.
+    CHECK(pool.submit(2, 1, []() { throw std::runtime_error("task failure"); }));
+    CHECK(pool.submit(2, 1, [&]() { ++ran; }));
+    release = true;
+    CHECK(waitFor([&]() { return ran == 4; }));
+    CHECK(pool.pending() == 0);
+
+    pool.stop();
+    CHECK_FALSE(pool.try_submit([&]() { ++ran; }));
+    CHECK_FALSE(pool.submit(1, 1, [&]() { ++ran; }));
+    CHECK(ran == 4);
+}
+
+TEST_CASE("Pipeline: Stages Keep Their Threads Across Requests") {
+    using Threads = std::vector<std::thread::id>;
+    Pipeline<int, Threads> pipeline;
+    for (int stage = 0; stage < 3; ++stage) {
+        pipeline.addStage([](Pipeline<int, Threads>::Request& request) {
+            request.output.push_back(std::this_thread::get_id());
+        });
+    }
+    pipeline.start();
+    CHECK(pipeline.stageCount() == 3);
+    CHECK(pipeline.threadCount() == 3);
+
+    // Every request goes through the same three threads, none of them the caller's.
+    Threads first = pipeline.execute(0);
+    REQUIRE(first.size() == 3);
+    CHECK((first[0] != first[1]));
+    CHECK((first[1] != first[2]));
+    CHECK((first[0] != std::this_thread::get_id()));
+    for (int i = 1; i < 50; ++i) CHECK((pipeline.execute(i) == first));
+}
+
+TEST_CASE("Pipeline: Move-Only Requests Return Typed Results") {
+    using Input = std::unique_ptr<int>;
+    using Output = std::unique_ptr<std::string>;
+    Pipeline<Input, Output> pipeline;
+    pipeline.addStage([](Pipeline<Input, Output>::Request& request) {
+        request.output = std::make_unique<std::string>(std::to_string(*request.input));
+    });
+    pipeline.addStage([](Pipeline<Input, Output>::Request& request) {
+        *request.output += "#" + std::to_string(request.id);
+    });
+    pipeline.start();
+
+    // Each future gets the result of its own request, in any completion order.
+    std::vector<std::future<Output>> results;
+    for (int i = 0; i < 20; ++i) results.push_back(pipeline.submit(std::make_unique<int>(i * 10)));
+    for (int i = 0; i < 20; ++i) {
+        Output result = results[i].get();
+        REQUIRE(result);
+        CHECK(*result == std::to_string(i * 10) + "#" + std::to_string(i + 1));
+    }
+
+    // With a callback, the result is moved to it instead.
+    std::promise<std::string> delivered;
+    pipeline.submit(std::make_unique<int>(7), [&delivered](Output result) { delivered.set_value(*result); });
+    CHECK(delivered.get_future().get() == "7#21");
+}
+
+TEST_CASE("Pipeline: Requests Refused Or Dropped By A Full Stage Fail") {
+    for (ActiveObject::OverflowPolicy policy : {ActiveObject::OverflowPolicy::Reject, ActiveObject::OverflowPolicy::DropOldest}) {
+        std::promise<void> gate;
+        std::shared_future<void> open = gate.get_future().share();
+        std::atomic<bool> started{false};
+        Pipeline<int, int> pipeline(1, policy);
+        pipeline.addStage([&](Pipeline<int, int>::Request& request) {
+            started = true;
+            open.wait();
+            request.output = request.input * 2;
+        });
+        pipeline.start();
+
+        std::future<int> first = pipeline.submit(1);
+        while (!started) std::this_thread::yield();
+        std::future<int> second = pipeline.submit(2); // Fills the queue.
+
+        std::promise<int> third;
+        std::future<int> thirdResult = third.get_future();
+        pipeline.submit(3, [&third](int output) { third.set_value(output); },
+                        [&third](std::exception_ptr e) { third.set_exception(e); });
+        if (policy == ActiveObject::OverflowPolicy::Reject) {
+            // Refused on the spot: onError runs before submit returns.
+            REQUIRE(thirdResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+            CHECK_THROWS_AS(thirdResult.get(), PipelineOverflow);
+            gate.set_value();
+            CHECK(first.get() == 2);
+            CHECK(second.get() == 4);
+        } else {
+            // The queued request made room for the new one.
+            CHECK_THROWS_AS(second.get(), PipelineOverflow);
+            gate.set_value();
+            CHECK(first.get() == 2);
+            CHECK(thirdResult.get() == 6);
+        }
+    }
+}
+
+TEST_CASE("Pipeline: Parallel Branches Run Together And Fan In") {
+    constexpr size_t BRANCHES = 3;
+    using Parts = std::array<int, BRANCHES + 1>;
+    std::atomic<size_t> arrived{0};
+    std::vector<Pipeline<int, Parts>::Stage> branches;
+    for (size_t branch = 0; branch < BRANCHES; ++branch) {
+        branches.push_back([&arrived, branch](Pipeline<int, Parts>::Request& request) {
+            // Only finishes once every branch has started on this request: they run concurrently.
+            ++arrived;
+            REQUIRE(waitFor([&arrived, &request]() { return arrived >= BRANCHES * static_cast<size_t>(request.input); }));
+            request.output[branch] = request.input * static_cast<int>(branch + 1);
+        });
+    }
+    Pipeline<int, Parts> pipeline;
+    pipeline.addParallelStage(std::move(branches));
+    // The next stage sees the parts written by every branch.
+    pipeline.addStage([](Pipeline<int, Parts>::Request& request) {
+        request.output[BRANCHES] = request.output[0] + request.output[1] + request.output[2];
+    });
+    pipeline.start();
+    CHECK(pipeline.threadCount() == BRANCHES + 1);
+
+    for (int input = 1; input <= 5; ++input) {
+        Parts parts = pipeline.execute(input);
+        CHECK(parts[0] == input);
+        CHECK(parts[1] == 2 * input);
+        CHECK(parts[2] == 3 * input);
+        CHECK(parts[3] == 6 * input);
+    }
+}
+
+TEST_CASE("Pipeline: Any Exception Thrown By A Branch Reaches The Caller") {
+    Pipeline<int, int> pipeline;
+    pipeline.addParallelStage({[](Pipeline<int, int>::Request& request) { request.output += request.input; },
+                               [](Pipeline<int, int>::Request&) { throw 42; }});
+    pipeline.start();
+
+    std::promise<std::exception_ptr> failure;
+    pipeline.submit(1, [](int) {}, [&failure](std::exception_ptr e) { failure.set_value(e); });
+    std::exception_ptr error = failure.get_future().get();
+    REQUIRE(error);
+    CHECK_THROWS_AS(std::rethrow_exception(error), int);
+    CHECK_THROWS_AS(pipeline.execute(1), int);
+}
+
+TEST_CASE("ChaseLevDeque: Owner Order, Wrap-Around And Growth") {
+    ChaseLevDeque<int> deque(4);
+    int item = 0;
+    CHECK_FALSE(deque.pop(item));
+    CHECK_FALSE(deque.steal(item));
+
+    // Indices keep increasing: the slots of a 4-element array are reused many times over.
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 3; ++i) deque.push(round * 3 + i);
+        REQUIRE(deque.steal(item));
+        CHECK(item == round * 3);       // Thieves take the oldest...
+        REQUIRE(deque.pop(item));
+        CHECK(item == round * 3 + 2);   // ...the owner the newest.
+        REQUIRE(deque.pop(item));
+        CHECK(item == round * 3 + 1);
+        CHECK(deque.empty());
+    }
+
+    // Growth keeps the elements in place, even after wrapping around.
+    for (int i = 0; i < 100; ++i) deque.push(i);
+    CHECK(deque.size() == 100);
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(deque.steal(item));
+        CHECK(item == i);
+    }
+    for (int i = 99; i >= 50; --i) {
+        REQUIRE(deque.pop(item));
+        CHECK(item == i);
+    }
+    CHECK_FALSE(deque.pop(item));
+}
+
+TEST_CASE("ChaseLevDeque: Every Item Is Taken Once Under Concurrent Steals") {
+    constexpr int ITEMS = 200000;
+    constexpr int THIEVES = 3;
+    ChaseLevDeque<int> deque(8); // Grows while the thieves are stealing.
+    std::vector<std::atomic<int>> taken(ITEMS);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < THIEVES; ++t) {
+        thieves.emplace_back([&]() {
+            int item;
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (deque.steal(item)) taken[item].fetch_add(1, std::memory_order_relaxed);
+                else std::this_thread::yield();
+            }
+        });
+    }
+    // The owner pops one item for every three it pushes, racing the thieves for the last ones.
+    int item;
+    for (int i = 0; i < ITEMS; ++i) {
+        deque.push(i);
+        if (i % 3 == 2 && deque.pop(item)) taken[item].fetch_add(1, std::memory_order_relaxed);
+    }
+    while (deque.pop(item)) taken[item].fetch_add(1, std::memory_order_relaxed);
+    done.store(true, std::memory_order_release);
+    for (std::thread& thief : thieves) thief.join();
+
+    int wrong = 0;
+    for (int i = 0; i < ITEMS; ++i) wrong += taken[i].load() != 1;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("LeaderFollowers: A Watched Descriptor Is Disarmed Until Rearmed") {
+    std::atomic<int> events{0};
+    std::atomic<int> lastFd{-1};
+    LeaderFollowers pool(3, [&](int fd, uint32_t mask) {
+        CHECK((mask & EPOLLIN) != 0);
+        uint64_t count;
+        REQUIRE(read(fd, &count, sizeof(count)) == sizeof(count));
+        lastFd = fd;
+        ++events;
+    });
+    int fd = eventfd(0, EFD_NONBLOCK);
+    REQUIRE(fd >= 0);
+    pool.watch(fd, EPOLLIN);
+
+    signalEvent(fd);
+    CHECK(waitFor([&]() { return events == 1; }));
+    CHECK(lastFd == fd);
+    // One-shot: the next event waits for the handler's owner to rearm the descriptor.
+    signalEvent(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(events == 1);
+    pool.rearm(fd, EPOLLIN);
+    CHECK(waitFor([&]() { return events == 2; }));
+
+    // Once unwatched, the descriptor is no longer reported.
+    pool.unwatch(fd);
+    signalEvent(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(events == 2);
+    pool.stop();
+    close(fd);
+}
+
+TEST_CASE("LeaderFollowers: Events Of One Descriptor Are Never Handled Concurrently") {
+    constexpr int DESCRIPTORS = 4;
+    constexpr int ROUNDS = 200;
+    std::array<std::atomic<int>, DESCRIPTORS> inside{};
+    std::array<std::atomic<int>, DESCRIPTORS> handled{};
+    std::array<int, DESCRIPTORS> fds;
+    std::atomic<int> overlaps{0};
+    LeaderFollowers* self = nullptr;
+    LeaderFollowers pool(4, [&](int fd, uint32_t) {
+        int i = 0;
+        while (fds[i] != fd) ++i;
+        if (inside[i].fetch_add(1) != 0) ++overlaps;
+        uint64_t count;
+        REQUIRE(read(fd, &count, sizeof(count)) == sizeof(count));
+        std::this_thread::yield();
+        inside[i].fetch_sub(1);
+        ++handled[i];
+        self->rearm(fd, EPOLLIN);
+    });
+    self = &pool;
+    for (int& fd : fds) {
+        fd = eventfd(0, EFD_NONBLOCK);
+        REQUIRE(fd >= 0);
+        pool.watch(fd, EPOLLIN);
+    }
+    // Each descriptor is signalled again as soon as its previous event was handled.
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int i = 0; i < DESCRIPTORS; ++i) signalEvent(fds[i]);
+        CHECK(waitFor([&]() {
+            for (auto& count : handled) {
+                if (count <= round) return false;
+            }
+            return true;
+        }));
+    }
+    pool.stop();
+    CHECK(overlaps == 0);
+    for (int fd : fds) close(fd);
+}
+
+TEST_CASE("LeaderFollowers: Injected And Stolen Tasks All Run Once") {
+    constexpr int PRODUCERS = 4;
+    constexpr int TASKS = 5000;   // Per producer, each adding CHILDREN tasks from the pool.
+    constexpr int CHILDREN = 3;
+    constexpr int TOTAL = PRODUCERS * TASKS * (1 + CHILDREN);
+    std::atomic<int> ran{0};
+    {
+        LeaderFollowers pool(4);
+        // Tasks added from outside go through the injection queue; their children go to the
+        // deque of the thread running them, where the other threads steal them.
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&]() {
+                for (int i = 0; i < TASKS; ++i) {
+                    pool.add_task([&]() {
+                        for (int c = 0; c < CHILDREN; ++c) pool.add_task([&ran]() { ++ran; });
+                        ++ran;
+                    });
+                }
+            });
+        }
+        for (std::thread& producer : producers) producer.join();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (ran.load() < TOTAL && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(ran.load() == TOTAL);
+        pool.stop();
+    }
+    CHECK(ran.load() == TOTAL);
+}
+
+TEST_CASE("LeaderFollowers: Batches Of Tasks All Run Once") {
+    constexpr int BATCHES = 50;
+    constexpr int BATCH = 3 * static_cast<int>(LeaderFollowers::MAX_BATCH); // Drained in several lock takes.
+    std::atomic<int> ran{0};
+    LeaderFollowers pool(3);
+    std::vector<LeaderFollowers::Task> tasks;
+    for (int b = 0; b < BATCHES; ++b) {
+        tasks.clear();
+        // From outside the pool: one lock take and one eventfd write for the whole batch. Every
+        // other batch also adds a nested batch from a pool thread, to that thread's own deque.
+        for (int i = 0; i < BATCH; ++i) tasks.push_back([&ran]() { ++ran; });
+        if (b % 2 == 0) {
+            tasks.push_back([&pool, &ran]() {
+                std::vector<LeaderFollowers::Task> nested;
+                for (int i = 0; i < BATCH; ++i) nested.push_back([&ran]() { ++ran; });
+                pool.add_tasks(std::move(nested));
+            });
+        }
+        pool.add_tasks(std::move(tasks));
+    }
+    pool.add_tasks({}); // Nothing to signal.
+    const int total = BATCHES * BATCH + BATCHES / 2 * BATCH;
+    CHECK(waitFor([&]() { return ran == total; }));
+    pool.stop();
+    CHECK(ran == total);
+}
+
+TEST_CASE("LeaderFollowers: Submitted Tasks Return Their Value Or Exception") {
+    LeaderFollowers pool(2);
+    CHECK(pool.submit([]() { return 42; }).get() == 42);
+    auto owned = pool.submit([]() { return std::make_unique<std::string>("moved"); }).get(); // Move-only result.
+    REQUIRE(owned);
+    CHECK(*owned == "moved");
+
+    std::atomic<bool> ran{false};
+    TaskFuture<void> done = pool.submit([&ran]() { ran = true; });
+    REQUIRE(done.valid());
+    done.get();
+    CHECK(ran);
+    CHECK_FALSE(done.valid()); // Consumed once, like std::future.
+
+    TaskFuture<int> failed = pool.submit([]() -> int { throw std::runtime_error("task failure"); });
+    CHECK_THROWS_WITH_AS(failed.get(), "task failure", std::runtime_error);
+    pool.stop();
+}
+
+TEST_CASE("LeaderFollowers: Continuations Chain On The Pool") {
+    LeaderFollowers pool(2);
+    auto caller = std::this_thread::get_id();
+    std::atomic<bool> onPool{true};
+    TaskFuture<std::string> chained = pool.submit([]() { return 2; })
+                                          .then([](int value) { return value * 3; })
+                                          .then([&](int value) {
+                                              onPool = onPool && std::this_thread::get_id() != caller;
+                                              return std::to_string(value + 1);
+                                          });
+    CHECK(chained.get() == "7");
+    CHECK(onPool);
+
+    // A continuation added once the result is ready still runs.
+    TaskFuture<int> ready = pool.submit([]() { return 5; });
+    REQUIRE(waitFor([&]() { return ready.ready(); }));
+    CHECK(ready.then([](int value) { return value + 1; }).get() == 6);
+
+    // An exception skips the continuations and reaches the end of the chain.
+    std::atomic<int> skipped{0};
+    TaskFuture<void> broken = pool.submit([]() -> int { throw std::runtime_error("first"); })
+                                  .then([&skipped](int) { ++skipped; })
+                                  .then([&skipped]() { ++skipped; });
+    CHECK_THROWS_WITH_AS(broken.get(), "first", std::runtime_error);
+    CHECK(skipped == 0);
+    pool.stop();
+}
+
+TEST_CASE("LeaderFollowers: Nested Fork-Join From A Pool Thread") {
+    // Two threads only: a pool task waiting for subtasks must run them itself, not block.
+    LeaderFollowers pool(2);
+    constexpr long N = 20000;
+    TaskFuture<long> total = pool.submit([&pool]() {
+        return pool.parallel_reduce<long>(0, N, 0L, [&pool](long lo, long hi) {
+            // Each chunk forks again: its squares are summed by a nested parallel_for.
+            std::vector<long> squares(static_cast<size_t>(hi - lo));
+            pool.parallel_for<long>(lo, hi, [&squares, lo](long a, long b) {
+                for (long i = a; i < b; ++i) squares[static_cast<size_t>(i - lo)] = i * i;
+            }, 50);
+            long sum = 0;
+            for (long square : squares) sum += square;
+            return sum;
+        }, std::plus<long>(), 1000);
+    });
+    CHECK(total.get() == (N - 1) * N * (2 * N - 1) / 6);
+
+    // The chunks are combined in order.
+    std::string letters = pool.parallel_reduce<int>(0, 26, std::string(), [](int lo, int hi) {
+        std::string part;
+        for (int i = lo; i < hi; ++i) part += static_cast<char>('a' + i);
+        return part;
+    }, [](std::string a, const std::string& b) { return a + b; }, 3);
+    CHECK(letters == "abcdefghijklmnopqrstuvwxyz");
+
+    // Every chunk has run when the first exception is rethrown.
+    std::atomic<int> chunks{0};
+    TaskFuture<void> failing = pool.submit([&]() {
+        pool.parallel_for<int>(0, 64, [&chunks](int lo, int) {
+            ++chunks;
+            if (lo == 32) throw std::runtime_error("chunk failure");
+        }, 8);
+    });
+    CHECK_THROWS_WITH_AS(failing.get(), "chunk failure", std::runtime_error);
+    CHECK(chunks == 8);
+    pool.stop();
+}
+
+TEST_CASE("LeaderFollowers: The Pool Grows Past A Blocked Task And Shrinks Back") {
+    LeaderFollowers pool(1, 3);
+    CHECK(pool.thread_count() == 1);
+
+    // The only thread is held by a long task: the supervisor adds one for the task behind it.
+    std::atomic<bool> release{false};
+    std::atomic<bool> served{false};
+    pool.add_task([&release]() {
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    pool.add_task([&served]() { served = true; });
+    CHECK(waitFor([&]() { return served.load(); }));
+    CHECK(pool.thread_count() >= 2);
+    CHECK(pool.thread_count() <= 3);
+
+    // Once idle for IDLE_TIMEOUT, the extra threads retire down to the minimum.
+    release = true;
+    CHECK(waitFor([&]() { return pool.thread_count() == 1; }));
+
+    // The pool grows again after shrinking, and stop() joins every thread and the supervisor.
+    release = false;
+    served = false;
+    pool.add_task([&release]() {
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    pool.add_task([&served]() { served = true; });
+    CHECK(waitFor([&]() { return served.load(); }));
+    release = true;
+    pool.stop();
+    pool.stop();
+}
+
+TEST_CASE("Logger: Each Kind Of Part Is Formatted In Place") {
+    LogLine line;
+    line.append("text ");
+    line.append(std::string("string "));
+    line.append(std::string_view("view "));
+    line.append('c');
+    line.append(' ');
+    line.append(true);
+    line.append(' ');
+    line.append(-42);
+    line.append(' ');
+    line.append(18446744073709551615ull);
+    line.append(' ');
+    line.append(0.5);
+    line.append(' ');
+    line.append(1e20f);
+    CHECK(std::string(line.data(), line.size()) == "text string view c true -42 18446744073709551615 0.5 1e+20");
+
+    // A message is cut at LOG_LINE_SIZE.
+    LogLine longLine;
+    longLine.append(std::string(LOG_LINE_SIZE - 2, 'x'));
+    longLine.append(12345);
+    longLine.append("more");
+    CHECK(longLine.size() == LOG_LINE_SIZE);
+    CHECK(std::string(longLine.data() + LOG_LINE_SIZE - 2, 2) == "12");
+}
+
+TEST_CASE("Logger: Levels Filter Before Any Formatting") {
+    int evaluated = 0;
+    auto part = [&evaluated]() { return ++evaluated; };
+
+    setLogLevel(LogLevel::Error);
+    CHECK_FALSE(logEnabled(LogLevel::Info));
+    CHECK_FALSE(logEnabled(LogLevel::Warning));
+    CHECK(logEnabled(LogLevel::Error));
+    LOG_WARNING("filtered ", part()); // Below the runtime level: the arguments are not evaluated.
+    CHECK(evaluated == 0);
+    setLogLevel(LogLevel::Off);
+    CHECK_FALSE(logEnabled(LogLevel::Error));
+    LOG_ERROR("filtered ", part());
+    CHECK(evaluated == 0);
+
+#if LOG_MIN_LEVEL > 0
+    // Below LOG_MIN_LEVEL the call is compiled out, whatever the runtime level.
+    setLogLevel(LogLevel::Debug);
+    LOG_DEBUG("compiled out ", part());
+    CHECK(evaluated == 0);
+#endif
+    setLogLevel(LogLevel::Info);
+}
+
+TEST_CASE("Logger: Messages Are Written With Their Level Prefix") {
+    flushLogs(); // Earlier messages go to the real output.
+    std::ostringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+    setLogLevel(LogLevel::Info);
+    LOG_INFO("info ", 1);
+    LOG_WARNING("warning ", 2.5);
+    LOG_ERROR("error ", 'x');
+    log("plain");
+    flushLogs(); // Waits until the background thread has written them.
+    std::cout.rdbuf(original);
+    CHECK(captured.str() == "info 1\n[WARNING] warning 2.5\n[ERROR] error x\nplain\n");
+}
+
+TEST_CASE("CpuAffinity: CPU Lists Are Parsed Like taskset -c") {
+    CHECK(parseCpuList("5") == CpuSet{5});
+    CHECK(parseCpuList("0-3,6") == CpuSet{0, 1, 2, 3, 6});
+    CHECK(parseCpuList("2,2-3") == CpuSet{2, 2, 3});
+    CHECK(parseCpuList(std::to_string(CPU_SETSIZE - 1)) == CpuSet{CPU_SETSIZE - 1});
+    for (const char* malformed : {"", ",", "a", "1a", "1-", "-1", "3-1", "1,,2", "0-2x"}) {
+        CHECK_THROWS_AS(parseCpuList(malformed), std::invalid_argument);
+    }
+    CHECK_THROWS_AS(parseCpuList(std::to_string(CPU_SETSIZE)), std::invalid_argument);
+    CHECK_THROWS_AS(parseCpuList("0-" + std::to_string(CPU_SETSIZE)), std::invalid_argument);
+    CHECK(formatCpuList(parseCpuList("0-2,7")) == "0,1,2,7");
+}
+
+TEST_CASE("CpuAffinity: Topology Order Is A Permutation Of The Allowed CPUs") {
+    CpuSet allowed = allowedCpus();
+    REQUIRE_FALSE(allowed.empty());
+    CpuSet ordered = topologyOrder(allowed);
+    CHECK(std::is_permutation(ordered.begin(), ordered.end(), allowed.begin(), allowed.end()));
+
+    // Processors without a topology in /sys each count as their own core, in increasing order.
+    CpuSet unknown{CPU_SETSIZE - 1, CPU_SETSIZE - 3, CPU_SETSIZE - 2};
+    CHECK(topologyOrder(unknown) == CpuSet{CPU_SETSIZE - 3, CPU_SETSIZE - 2, CPU_SETSIZE - 1});
+
+    bool pinned = false;
+    std::thread probe([&]() { pinned = pinCurrentThread(allowed.front()); });
+    probe.join();
+    CHECK(pinned);
+    CHECK_FALSE(pinCurrentThread(-1));
+    CHECK_FALSE(pinCurrentThread(CPU_SETSIZE));
+}
+
+TEST_CASE("CpuAffinity: A Placement Hands Out Its CPUs In Turn") {
+    CpuPlacement placement(CpuSet{4, 1, 7});
+    CHECK(placement.enabled());
+    CHECK(placement.next() == 4);
+    CHECK(placement.take(4) == CpuSet{1, 7, 4, 1}); // Wraps around once the CPUs run out.
+    CHECK(placement.next() == 7);
+
+    CpuPlacement disabled;
+    CHECK_FALSE(disabled.enabled());
+    CHECK(disabled.next() == -1);
+    CHECK(disabled.take(3).empty());
+}
+
+TEST_CASE("FairQueue: Deficit Round Robin Serve Order") {
+    FairQueue<char, std::string> queue(10);
+    for (int i = 1; i <= 3; ++i) queue.push('A', "A" + std::to_string(i), 25); // Costs 2.5 quanta.
+    for (int i = 1; i <= 5; ++i) queue.push('B', "B" + std::to_string(i), 3);
+    queue.push('C', "C1", 10);
+
+    // A cannot pay before its third turn; B spends its quantum 3 by 3, keeping the change.
+    std::vector<std::string> order;
+    while (!queue.empty()) order.push_back(queue.pop());
+    CHECK(order == std::vector<std::string>{"B1", "B2", "B3", "C1", "B4", "B5", "A1", "A2", "A3"});
+}
+
+TEST_CASE("FairQueue: A Cheap Client Is Not Starved By A Heavy One") {
+    FairQueue<int, int> queue;
+    const uint64_t heavy = 100 * FairQueue<int, int>::DEFAULT_QUANTUM;
+    for (int i = 0; i < 100; ++i) queue.push(1, i, heavy);
+    queue.pop(); // The heavy client's first analysis is under way...
+
+    for (int i = 0; i < 10; ++i) queue.push(2, 1000 + i, 1);
+    // ...then the cheap client gets all its short commands through before the next one.
+    for (int i = 0; i < 10; ++i) CHECK(queue.pop() == 1000 + i);
+    CHECK(queue.pop() == 1);
+    CHECK(queue.size() == 98);
+}
+
+TEST_CASE("SpscRing: Bounded FIFO With Wrap-Around") {
+    SpscRing<std::unique_ptr<int>> ring(3);
+    CHECK(ring.capacity() == 4); // Rounded up to a power of two.
+
+    int next = 0, expected = 0;
+    for (int round = 0; round < 50; ++round) {
+        // Fill the ring, check it refuses more without taking the item, then empty it halfway.
+        for (;;) {
+            auto item = std::make_unique<int>(next);
+            if (!ring.try_push(item)) {
+                REQUIRE(item);
+                CHECK(*item == next);
+                break;
+            }
+            ++next;
+        }
+        CHECK(ring.size() == ring.capacity());
+        for (int i = 0; i < 2; ++i) {
+            std::unique_ptr<int> item;
+            REQUIRE(ring.try_pop(item));
+            CHECK(*item == expected++);
+        }
+    }
+    std::unique_ptr<int> item;
+    while (ring.try_pop(item)) CHECK(*item == expected++);
+    CHECK(expected == next);
+    CHECK(ring.empty());
+}
+
+TEST_CASE("SpscRing: Producer And Consumer Threads Keep The Order") {
+    constexpr int ITEMS = 200000;
+    SpscRing<int> ring(64);
+    std::thread producer([&ring]() {
+        for (int i = 0; i < ITEMS; ++i) {
+            int item = i;
+            while (!ring.try_push(item)) std::this_thread::yield();
+        }
+    });
+    int outOfOrder = 0;
+    for (int expected = 0; expected < ITEMS;) {
+        int item;
+        if (!ring.try_pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        outOfOrder += item != expected;
+        ++expected;
+    }
+    producer.join();
+    CHECK(outOfOrder == 0);
+    CHECK(ring.empty());
+}
+
+TEST_CASE("UniqueTask: Inline And Heap Captures, Moves And Destruction") {
+    auto state = std::make_shared<int>(0);
+
+    SUBCASE("Small capture, stored inline") {
+        UniqueTask task([state]() { ++*state; });
+        CHECK(state.use_count() == 2);
+        task();
+        UniqueTask moved(std::move(task));
+        CHECK_FALSE(task);
+        REQUIRE(moved);
+        moved();
+        CHECK(*state == 2);
+        moved = nullptr;
+        CHECK(state.use_count() == 1);
+    }
+    SUBCASE("Large capture, stored on the heap") {
+        std::array<char, 2 * UniqueTask::INLINE_SIZE> padding{};
+        padding[0] = 5;
+        UniqueTask task([state, padding]() { *state += padding[0]; });
+        UniqueTask moved;
+        moved = std::move(task);
+        CHECK_FALSE(task);
+        CHECK(state.use_count() == 2); // Moving the pointer copied nothing.
+        moved();
+        CHECK(*state == 5);
+        moved = UniqueTask();
+        CHECK(state.use_count() == 1);
+    }
+    SUBCASE("Move-only capture") {
+        auto owned = std::make_unique<int>(7);
+        UniqueTask task([owned = std::move(owned), state]() { *state = *owned; });
+        UniqueTask moved(std::move(task));
+        moved();
+        CHECK(*state == 7);
+    }
+}
+
+namespace {
+// Counts its moves; `NoThrow` picks whether UniqueTask may store it inline.
+template <bool NoThrow>
+struct MoveCounter {
+    int* moves;
+    explicit MoveCounter(int* moves) : moves(moves) {}
+    MoveCounter(MoveCounter&& other) noexcept(NoThrow) : moves(other.moves) { ++*moves; }
+    void operator()() const {}
+};
+} // namespace
+
+TEST_CASE("UniqueTask: Only Nothrow-Movable Small Captures Are Stored Inline") {
+    int inlineMoves = 0, heapMoves = 0;
+    UniqueTask inlined{MoveCounter<true>(&inlineMoves)};
+    UniqueTask onHeap{MoveCounter<false>(&heapMoves)};
+    inlineMoves = heapMoves = 0;
+
+    // An inline function moves with its task; a heap one stays put, only its pointer changes hands.
+    UniqueTask movedInline(std::move(inlined));
+    UniqueTask movedHeap(std::move(onHeap));
+    CHECK(inlineMoves == 1);
+    CHECK(heapMoves == 0);
+    movedInline();
+    movedHeap();
+}
+
+TEST_CASE("UniqueTask: Assignment Releases The Previous Capture") {
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    UniqueTask task([first]() {});
+    task = UniqueTask([second]() {});
+    CHECK(first.use_count() == 1);
+    CHECK(second.use_count() == 2);
+    UniqueTask& self = task;
+    task = std::move(self); // Self-assignment keeps the capture.
+    CHECK(task);
+    CHECK(second.use_count() == 2);
+}
+
+TEST_CASE("UniqueTask: Move-Only Tasks Go Through Every Task Queue") {
+    // A promise can only be moved: std::function could not hold these tasks.
+    auto promised = [](std::vector<std::future<int>>& futures, int value) {
+        std::promise<int> promise;
+        futures.push_back(promise.get_future());
+        return [promise = std::move(promise), value]() mutable { promise.set_value(value); };
+    };
+    std::vector<std::future<int>> futures;
+    LeaderFollowers leaderFollowers(2);
+    WorkerPool workers(2, 16);
+    ActiveObject object;
+    object.start();
+    leaderFollowers.add_task(promised(futures, 1));
+    CHECK(workers.try_submit(promised(futures, 2)));
+    CHECK(object.enqueue(promised(futures, 3)));
+    for (int i = 0; i < 3; ++i) CHECK(futures[i].get() == i + 1);
+    object.stop();
+    workers.stop();
+    leaderFollowers.stop();
+}
+
+TEST_CASE("ActiveObject: Overflow Policies") {
+    using Policy = ActiveObject::OverflowPolicy;
+    for (Policy policy : {Policy::Block, Policy::Reject, Policy::DropOldest}) {
+        CAPTURE(static_cast<int>(policy));
+        std::promise<void> gate;
+        std::shared_future<void> open = gate.get_future().share();
+        std::atomic<bool> started{false};
+        std::mutex mutex;
+        std::vector<int> ran;
+        auto record = [&](int id) {
+            return [&, id]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                ran.push_back(id);
+            };
+        };
+
+        ActiveObject object(1, policy);
+        object.start();
+        REQUIRE(object.enqueue([&]() {
+            started = true;
+            open.wait();
+        }));
+        while (!started) std::this_thread::yield();
+        REQUIRE(object.enqueue(record(1))); // Fills the queue.
+
+        if (policy == Policy::Block) {
+            std::atomic<bool> accepted{false};
+            std::thread producer([&]() { accepted = object.enqueue(record(2)); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK_FALSE(accepted); // Still waiting for room.
+            gate.set_value();
+            producer.join();
+            CHECK(accepted);
+        } else {
+            bool accepted = object.enqueue(record(2));
+            CHECK(accepted == (policy == Policy::DropOldest));
+            gate.set_value();
+        }
+        object.stop(); // Runs the tasks already accepted.
+        CHECK(object.dropped() == (policy == Policy::DropOldest ? 1u : 0u));
+        if (policy == Policy::Block) CHECK(ran == std::vector<int>{1, 2});
+        if (policy == Policy::Reject) CHECK(ran == std::vector<int>{1});
+        if (policy == Policy::DropOldest) CHECK(ran == std::vector<int>{2});
+        CHECK_FALSE(object.enqueue(record(3)));
+    }
+}
+
+TEST_CASE("ActiveObject: try_enqueue Never Waits On A Full Queue") {
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    std::atomic<bool> started{false};
+    std::atomic<int> ran{0};
+    ActiveObject object(2, ActiveObject::OverflowPolicy::Block);
+    object.start();
+    REQUIRE(object.enqueue([&]() {
+        started = true;
+        open.wait();
+    }));
+    while (!started) std::this_thread::yield();
+
+    CHECK(object.try_enqueue([&]() { ++ran; }));
+    CHECK(object.try_enqueue([&]() { ++ran; }));
+    CHECK_FALSE(object.try_enqueue([&]() { ++ran; })); // Full: refused even with Block.
+    CHECK(object.depth() == 2);
+    CHECK(object.highWaterMark() == 2);
+    CHECK(object.dropped() == 0);
+
+    gate.set_value();
+    object.stop();
+    CHECK(ran == 2);
+    CHECK(object.depth() == 0);
+    CHECK_FALSE(object.try_enqueue([&]() { ++ran; }));
+}
+
+TEST_CASE("ActiveObject: Bulk Enqueue Keeps The Order And The Policy") {
+    using Policy = ActiveObject::OverflowPolicy;
+    for (bool singleProducer : {false, true}) {
+        CAPTURE(singleProducer);
+        // Larger than the queue: with Block, the batch waits for the thread to make room.
+        std::vector<int> ran;
+        ActiveObject object(4, Policy::Block, singleProducer);
+        object.start();
+        std::vector<ActiveObject::Task> batch;
+        for (int i = 0; i < 20; ++i) batch.push_back([&ran, i]() { ran.push_back(i); });
+        CHECK(object.enqueue_bulk(std::move(batch)) == 20);
+        object.stop();
+        REQUIRE(ran.size() == 20);
+        for (int i = 0; i < 20; ++i) CHECK(ran[i] == i);
+    }
+
+    // With Reject, the tasks beyond the free room are refused, the first ones kept.
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    std::atomic<bool> started{false};
+    std::atomic<int> ran{0};
+    ActiveObject object(3, Policy::Reject);
+    object.start();
+    REQUIRE(object.enqueue([&]() {
+        started = true;
+        open.wait();
+    }));
+    while (!started) std::this_thread::yield();
+    std::vector<ActiveObject::Task> batch;
+    for (int i = 0; i < 5; ++i) batch.push_back([&ran]() { ++ran; });
+    CHECK(object.enqueue_bulk(std::move(batch)) == 3);
+    gate.set_value();
+    object.stop();
+    CHECK(ran == 3);
+}
+
+TEST_CASE("ActiveObject: Stop Runs The Tasks Already Queued") {
+    for (bool singleProducer : {false, true}) {
+        CAPTURE(singleProducer);
+        std::promise<void> gate;
+        std::shared_future<void> open = gate.get_future().share();
+        std::atomic<int> ran{0};
+        ActiveObject object(0, ActiveObject::OverflowPolicy::Block, singleProducer);
+        object.start();
+        object.enqueue([open]() { open.wait(); });
+        for (int i = 0; i < 100; ++i) object.enqueue([&ran]() { ++ran; });
+        gate.set_value();
+        object.stop();
+        CHECK(ran == 100);
+    }
+}
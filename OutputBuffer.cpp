@@ -0,0 +1,182 @@
+#include "OutputBuffer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+OutputBuffer& OutputBuffer::operator<<(std::string_view text) {
+    write(text.data(), text.size());
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(char c) {
+    write(&c, 1);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(int value) {
+    return *this << static_cast<long long>(value);
+}
+
+OutputBuffer& OutputBuffer::operator<<(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(size_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double value) {
+    char digits[512];
+    int length = std::snprintf(digits, sizeof(digits), "%f", value);
+    if (length > 0) write(digits, std::min(static_cast<size_t>(length), sizeof(digits) - 1));
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append(const OutputBuffer& other) {
+    for (size_t i = 0; i < other._chunks.size(); ++i) {
+        size_t begin = i == 0 ? other._head : 0;
+        size_t end = i + 1 == other._chunks.size() ? other._tail : CHUNK_SIZE;
+        write(other._chunks[i].get() + begin, end - begin);
+    }
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::pad(size_t count, char fill) {
+    while (count > 0) {
+        if (_chunks.empty() || _tail == CHUNK_SIZE) addChunk();
+        size_t step = std::min(count, CHUNK_SIZE - _tail);
+        std::memset(_chunks.back().get() + _tail, fill, step);
+        _tail += step;
+        _size += step;
+        count -= step;
+    }
+    maybeDrain();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::writeU8(uint8_t value) {
+    write(reinterpret_cast<const char*>(&value), 1);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::writeU32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    write(bytes, sizeof(bytes));
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::writeI32(int32_t value) {
+    return writeU32(static_cast<uint32_t>(value));
+}
+
+OutputBuffer& OutputBuffer::writeF64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    write(bytes, sizeof(bytes));
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::writeFrameHeader(FrameType type, uint32_t payloadSize) {
+    writeU32(payloadSize);
+    return writeU8(type);
+}
+
+void OutputBuffer::clear() {
+    while (!_chunks.empty()) releaseFront();
+    _head = 0;
+    _tail = 0;
+    _size = 0;
+}
+
+void OutputBuffer::consume(size_t count) {
+    count = std::min(count, _size);
+    while (count > 0) {
+        size_t end = _chunks.size() == 1 ? _tail : CHUNK_SIZE;
+        size_t step = std::min(count, end - _head);
+        _head += step;
+        _size -= step;
+        count -= step;
+        if (_head == end) {
+            if (_chunks.size() == 1) {
+                clear();
+                return;
+            }
+            releaseFront();
+            _head = 0;
+        }
+    }
+}
+
+int OutputBuffer::gather(struct iovec* iov, int max) const {
+    int used = 0;
+    for (size_t i = 0; i < _chunks.size() && used < max; ++i) {
+        size_t begin = i == 0 ? _head : 0;
+        size_t end = i + 1 == _chunks.size() ? _tail : CHUNK_SIZE;
+        if (end == begin) continue;
+        iov[used].iov_base = _chunks[i].get() + begin;
+        iov[used].iov_len = end - begin;
+        ++used;
+    }
+    return used;
+}
+
+std::string OutputBuffer::str() const {
+    std::string result;
+    result.reserve(_size);
+    for (size_t i = 0; i < _chunks.size(); ++i) {
+        size_t begin = i == 0 ? _head : 0;
+        size_t end = i + 1 == _chunks.size() ? _tail : CHUNK_SIZE;
+        result.append(_chunks[i].get() + begin, end - begin);
+    }
+    return result;
+}
+
+void OutputBuffer::setDrain(size_t limit, std::function<void(OutputBuffer&)> drain) {
+    _drainLimit = limit;
+    _drain = std::move(drain);
+}
+
+void OutputBuffer::write(const char* data, size_t count) {
+    while (count > 0) {
+        if (_chunks.empty() || _tail == CHUNK_SIZE) addChunk();
+        size_t step = std::min(count, CHUNK_SIZE - _tail);
+        std::memcpy(_chunks.back().get() + _tail, data, step);
+        _tail += step;
+        _size += step;
+        data += step;
+        count -= step;
+    }
+    maybeDrain();
+}
+
+void OutputBuffer::addChunk() {
+    if (!_spare.empty()) {
+        _chunks.push_back(std::move(_spare.back()));
+        _spare.pop_back();
+    } else {
+        _chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+    }
+    _tail = 0;
+}
+
+void OutputBuffer::releaseFront() {
+    if (_spare.size() < MAX_SPARE_CHUNKS) _spare.push_back(std::move(_chunks.front()));
+    _chunks.pop_front();
+}
+
+void OutputBuffer::maybeDrain() {
+    if (_drainLimit == 0 || _size < _drainLimit || _draining || !_drain) return;
+    _draining = true;
+    _drain(*this);
+    _draining = false;
+}
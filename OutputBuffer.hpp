@@ -0,0 +1,107 @@
+#ifndef OUTPUTBUFFER_HPP
+#define OUTPUTBUFFER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/uio.h>
+
+/*
+ * Binary responses (negotiated with the 'format binary' command) are sent as frames:
+ *     [u32 payload length][u8 FrameType][payload]
+ * All integers are little-endian, doubles are IEEE-754 binary64 stored little-endian.
+ */
+enum FrameType : uint8_t {
+    FRAME_TEXT     = 1,  // Payload: UTF-8 text (acknowledgements, errors, help).
+    FRAME_ANALYSIS = 2,  // Payload: analysis sections (see Graph::writeAnalysisBinary).
+    FRAME_EDGES    = 3   // Payload: a page of graph or MST edges (see Graph::writeEdgesBinary).
+};
+constexpr size_t FRAME_HEADER_SIZE = 5;
+
+/*
+ * OutputBuffer:
+ * A chunked, reusable byte buffer that text is formatted into directly (numbers are written with
+ * std::to_chars, padding with a fill), so building a large response creates no temporary strings.
+ *
+ * Data lives in fixed-size chunks; every chunk except the last one is full. Consumed chunks are
+ * kept as spares and reused by later writes instead of being freed.
+ *
+ * An optional drain callback bounds the memory used: as soon as the buffered size reaches the drain
+ * limit, the callback is invoked and is expected to consume (e.g. send) the buffered bytes. This
+ * lets a huge dump be streamed to a socket without ever being materialized in full.
+ */
+class OutputBuffer {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    // Spare chunks kept for reuse; anything beyond is released.
+    static constexpr size_t MAX_SPARE_CHUNKS = 8;
+
+    OutputBuffer() = default;
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    // Appends text, a character or a formatted number.
+    OutputBuffer& operator<<(std::string_view text);
+    OutputBuffer& operator<<(const char* text) { return *this << std::string_view(text); }
+    OutputBuffer& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    OutputBuffer& operator<<(char c);
+    OutputBuffer& operator<<(int value);
+    OutputBuffer& operator<<(long long value);
+    OutputBuffer& operator<<(size_t value);
+    // Doubles use the same "%f" format as std::to_string.
+    OutputBuffer& operator<<(double value);
+    // Appends the bytes buffered in `other` (which is left unchanged).
+    OutputBuffer& append(const OutputBuffer& other);
+    // Appends `count` copies of `fill` (used for the 15-space indentation of the displays).
+    OutputBuffer& pad(size_t count, char fill = ' ');
+
+    // Binary encoders (little-endian) used by the binary response format.
+    OutputBuffer& writeU8(uint8_t value);
+    OutputBuffer& writeU32(uint32_t value);
+    OutputBuffer& writeI32(int32_t value);
+    OutputBuffer& writeF64(double value);
+    // Starts a frame whose payload of `payloadSize` bytes must be written right after.
+    OutputBuffer& writeFrameHeader(FrameType type, uint32_t payloadSize);
+
+    // Number of buffered bytes.
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    // Drops all buffered bytes, keeping the chunks for reuse.
+    void clear();
+    // Frees the spare chunks (e.g. before a connection goes idle for a long time).
+    void releaseSpares() { _spare.clear(); }
+    // Drops the first `count` buffered bytes (e.g. after a partial send).
+    void consume(size_t count);
+    // Fills up to `max` iovecs with the buffered bytes, in order, and returns how many were used.
+    int gather(struct iovec* iov, int max) const;
+    // Copies the buffered bytes into a string.
+    std::string str() const;
+
+    // Invokes `drain` whenever at least `limit` bytes are buffered (limit 0 disables draining).
+    void setDrain(size_t limit, std::function<void(OutputBuffer&)> drain);
+
+private:
+    std::deque<std::unique_ptr<char[]>> _chunks;  // Chunks holding buffered data.
+    std::vector<std::unique_ptr<char[]>> _spare;  // Free chunks reused by later writes.
+    size_t _head = 0;                             // First unread byte in _chunks.front().
+    size_t _tail = 0;                             // Bytes written in _chunks.back().
+    size_t _size = 0;
+    size_t _drainLimit = 0;
+    std::function<void(OutputBuffer&)> _drain;
+    bool _draining = false;
+
+    // Appends raw bytes, spilling over into new chunks as needed.
+    void write(const char* data, size_t count);
+    // Adds an empty chunk at the back, reusing a spare one if possible.
+    void addChunk();
+    // Moves the front chunk to the spares.
+    void releaseFront();
+    // Runs the drain callback if the limit is reached.
+    void maybeDrain();
+};
+
+#endif // OUTPUTBUFFER_HPP
@@ -2,44 +2,283 @@
 #define PIPELINE_HPP
 
 #include "ActiveObject.hpp"
-#include <vector>
+#include "Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <future>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Erreur d'une requête qu'une étape n'a pas exécutée (file pleine ou pipeline arrêté).
+ */
+class PipelineOverflow : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
 
 /**
  * @class Pipeline
- * @brief Représente un pipeline composé d'ActiveObjects, créé automatiquement pour les tâches fournies.
+ * @brief Pipeline persistant et typé d'étapes (ActiveObjects) partagé par toutes les requêtes.
+ *
+ * Une requête transporte une entrée `In` et un résultat `Out`, que chaque étape complète sur place.
+ * Les étapes sont ajoutées puis démarrées une seule fois ; chaque étape garde son thread pour toute
+ * la durée de vie du pipeline. La requête n'est jamais copiée : elle est créée par `submit`, passe
+ * d'étape en étape, puis son résultat est déplacé dans le `std::future` (ou passé au callback).
+ * `In` et `Out` peuvent donc être des types non copiables.
+ *
+ * Une étape peut aussi être parallèle (`addParallelStage`) : ses branches, chacune sur son propre
+ * ActiveObject, traitent la même requête en même temps, et la requête ne passe à l'étape suivante
+ * que lorsque toutes les branches ont terminé (fan-out / fan-in). Les branches d'une même étape
+ * ne doivent donc modifier que des parties disjointes de la requête.
+ *
+ * Les files des étapes peuvent être bornées (voir `ActiveObject::OverflowPolicy`). Avec `Block`, une
+ * étape lente ralentit celles qui l'alimentent, jusqu'à `submit`. Une requête refusée par une file
+ * pleine (`Reject`), abandonnée pour faire place à une plus récente (`DropOldest`) ou refusée par
+ * une étape arrêtée échoue avec PipelineOverflow.
+ *
+ * Une exception levée par une étape interrompt la requête. L'erreur d'une requête est transmise à
+ * son `std::future`, ou à son `onError`.
+ *
+ * @tparam In Type de l'entrée d'une requête, lue par les étapes.
+ * @tparam Out Type du résultat, construit par défaut puis complété par chaque étape.
  */
+template <typename In, typename Out>
 class Pipeline {
 public:
-    Pipeline();
-    ~Pipeline();
+    /**
+     * @brief Requête en transit dans le pipeline.
+     */
+    struct Request {
+        uint64_t id; ///< Identifiant attribué par `submit`.
+        In input;    ///< Données d'entrée.
+        Out output;  ///< Résultat, complété par chaque étape.
+    };
+    using Stage = std::function<void(Request&)>;
+    using Callback = std::function<void(Out)>;
+    using ErrorCallback = std::function<void(std::exception_ptr)>;
+
+    /**
+     * @param capacity Capacité de la file de chaque étape (0 : non bornée).
+     * @param policy Politique appliquée par une file pleine.
+     */
+    explicit Pipeline(size_t capacity = 0, ActiveObject::OverflowPolicy policy = ActiveObject::OverflowPolicy::Block)
+        : capacity(capacity), policy(policy) {}
+    ~Pipeline() { stop(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Ajoute une étape à la fin du pipeline (avant `start`).
+     */
+    void addStage(Stage stage) {
+        std::vector<Stage> branches;
+        branches.push_back(std::move(stage));
+        addParallelStage(std::move(branches));
+    }
 
     /**
-     * @brief Ajoute une tâche au pipeline.
-     * @param task Une fonction qui renvoie un std::string.
+     * @brief Ajoute une étape dont les branches s'exécutent en parallèle sur chaque requête (avant `start`).
      */
-    void addTask(std::function<std::string()> task);
+    void addParallelStage(std::vector<Stage> branches) {
+        // Une étape qui suit une étape à une seule branche n'est alimentée que par le thread de
+        // celle-ci : ses files sont alors des anneaux SPSC sans verrou. La première étape
+        // (alimentée par `submit`) et celle qui suit une étape parallèle gardent une file partagée.
+        bool singleProducer = !stages.empty() && stages.back().branches.size() == 1;
+        StageSlot slot;
+        for (auto& branch : branches) {
+            slot.branches.push_back(std::move(branch));
+            slot.objects.push_back(std::make_unique<ActiveObject>(capacity, policy, singleProducer));
+        }
+        stages.push_back(std::move(slot));
+        LOG_DEBUG("[Pipeline] New stage added (", stages.back().branches.size(),
+                  " branch(es)). Total stages: ", stages.size());
+    }
 
     /**
-     * @brief Démarre toutes les étapes du pipeline.
+     * @brief Démarre les threads de toutes les étapes.
+     * @param cpus Cœur de chaque thread, étape par étape et branche par branche (vide : threads non
+     *             fixés) ; voir `threadCount`.
      */
-    void start();
+    void start(const CpuSet& cpus = {}) {
+        LOG_DEBUG("[Pipeline] Starting all stages...");
+        size_t index = 0;
+        for (auto& stage : stages) {
+            for (auto& object : stage.objects) {
+                object->start(index < cpus.size() ? cpus[index] : -1);
+                ++index;
+            }
+        }
+    }
 
     /**
-     * @brief Exécute le pipeline en transmettant un std::string partagé entre les étapes.
-     * @param sharedData La chaîne partagée entre les étapes.
+     * @brief Nombre de threads du pipeline (un par branche de chaque étape).
      */
-    std::string execute();
+    size_t threadCount() const {
+        size_t count = 0;
+        for (const auto& stage : stages) count += stage.objects.size();
+        return count;
+    }
+
+    /**
+     * @brief Soumet une requête à la première étape.
+     * @return Le résultat, disponible lorsque la requête a traversé toutes les étapes.
+     */
+    std::future<Out> submit(In input) {
+        auto job = makeJob(std::move(input));
+        std::future<Out> result = job->promise.get_future();
+        forward(0, std::move(job));
+        return result;
+    }
+
+    /**
+     * @brief Soumet une requête ; `callback` reçoit le résultat sur le thread de la dernière étape.
+     * Si une étape échoue, `onError` (s'il est fourni) reçoit l'exception à la place.
+     */
+    void submit(In input, Callback callback, ErrorCallback onError = nullptr) {
+        auto job = makeJob(std::move(input));
+        job->callback = std::move(callback);
+        job->onError = std::move(onError);
+        forward(0, std::move(job));
+    }
+
+    /**
+     * @brief Soumet une requête et attend son résultat.
+     */
+    Out execute(In input) {
+        return submit(std::move(input)).get();
+    }
+
+    size_t stageCount() const { return stages.size(); }
+
+    /**
+     * @brief Plus grande profondeur de file observée parmi les branches de l'étape `index`.
+     */
+    size_t highWaterMark(size_t index) {
+        size_t mark = 0;
+        for (auto& object : stages[index].objects) mark = std::max(mark, object->highWaterMark());
+        return mark;
+    }
 
     /**
      * @brief Arrête toutes les étapes du pipeline.
      */
-    void stop();
+    void stop() {
+        for (auto& stage : stages) {
+            for (auto& object : stage.objects) object->stop();
+        }
+    }
 
 private:
-    std::vector<std::shared_ptr<ActiveObject>> stages; ///< Étapes du pipeline.
+    // Une étape : une branche (étape séquentielle) ou plusieurs (étape parallèle), chacune avec son thread.
+    struct StageSlot {
+        std::vector<Stage> branches;
+        std::vector<std::unique_ptr<ActiveObject>> objects;
+    };
+
+    // Requête, destinataire de son résultat et état du fan-in de l'étape en cours.
+    struct Job {
+        Request request;
+        std::promise<Out> promise;
+        Callback callback;
+        ErrorCallback onError;
+        std::atomic<size_t> pending{0};     ///< Branches de l'étape en cours pas encore terminées.
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;           ///< Première exception levée par une branche.
+    };
+
+    std::vector<StageSlot> stages;
+    std::atomic<uint64_t> nextId{1};
+    size_t capacity;
+    ActiveObject::OverflowPolicy policy;
+
+    std::shared_ptr<Job> makeJob(In input) {
+        auto job = std::make_shared<Job>();
+        job->request.id = nextId++;
+        job->request.input = std::move(input);
+        return job;
+    }
+
+    // Confie la requête à toutes les branches de l'étape `index`, ou livre son résultat après la
+    // dernière étape. Le pointeur partagé ne sert qu'à passer la requête dans les files des ActiveObjects.
+    void forward(size_t index, std::shared_ptr<Job> job) {
+        if (index == stages.size()) {
+            if (job->callback) job->callback(std::move(job->request.output));
+            else job->promise.set_value(std::move(job->request.output));
+            return;
+        }
+        StageSlot& stage = stages[index];
+        job->pending = stage.branches.size();
+        for (size_t branch = 0; branch < stage.branches.size(); ++branch) {
+            // Refusée, la tâche est détruite sans avoir été exécutée : BranchTask fait échouer la requête.
+            stage.objects[branch]->enqueue(BranchTask(this, index, branch, job));
+        }
+    }
+
+    // Tâche d'une branche. Détruite sans avoir été exécutée (refusée, abandonnée par `DropOldest` ou
+    // restée en file à l'arrêt), elle termine la branche en échec : la requête rend toujours son
+    // résultat ou son erreur.
+    class BranchTask {
+    public:
+        BranchTask(Pipeline* pipeline, size_t index, size_t branch, std::shared_ptr<Job> job)
+            : pipeline(pipeline), index(index), branch(branch), job(std::move(job)) {}
+        BranchTask(BranchTask&&) = default;
+        BranchTask& operator=(BranchTask&&) = delete;
+        ~BranchTask() {
+            if (!job) return;
+            fail(*job, std::make_exception_ptr(PipelineOverflow(
+                "Pipeline stage " + std::to_string(index) + " did not run the request")));
+            pipeline->branchDone(index, job);
+        }
+
+        void operator()() {
+            std::shared_ptr<Job> running = std::move(job);
+            pipeline->runBranch(index, branch, running);
+        }
+
+    private:
+        Pipeline* pipeline;
+        size_t index;
+        size_t branch;
+        std::shared_ptr<Job> job; ///< Nul une fois la tâche exécutée (ou déplacée).
+    };
+
+    // Retient la première erreur de la requête.
+    static void fail(Job& job, std::exception_ptr error) {
+        if (!job.failed.exchange(true)) job.error = std::move(error);
+    }
+
+    // Exécute une branche ; la dernière branche à terminer fait passer la requête à l'étape suivante.
+    void runBranch(size_t index, size_t branch, const std::shared_ptr<Job>& job) {
+        try {
+            stages[index].branches[branch](job->request);
+        } catch (const std::exception& e) {
+            LOG_WARNING("[Pipeline] Stage ", index, " failed: ", e.what());
+            fail(*job, std::current_exception());
+        } catch (...) {
+            LOG_WARNING("[Pipeline] Stage ", index, " failed.");
+            fail(*job, std::current_exception());
+        }
+        branchDone(index, job);
+    }
+
+    // Fan-in : la dernière branche de l'étape `index` à terminer termine la requête ou la fait avancer.
+    void branchDone(size_t index, const std::shared_ptr<Job>& job) {
+        if (--job->pending != 0) return;
+        if (job->failed) {
+            if (!job->callback) job->promise.set_exception(job->error);
+            else if (job->onError) job->onError(job->error);
+            return;
+        }
+        forward(index + 1, job);
+    }
 };
 
-#endif // PIPELINE_HPP
\ No newline at end of file
+#endif // PIPELINE_HPP
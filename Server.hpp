@@ -1,6 +1,7 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include <cstdint>
 #include <string>
 #include <unordered_set>
 #include <iostream>
@@ -10,17 +11,22 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include "Logger.hpp"
 
 class Server {
 protected:
     int port;                                      // Port d'écoute
     std::string address;                           // Adresse IP ou nom d'hôte
     std::unordered_set<int> connectedClients;      // Ensemble des clients connectés
+    std::mutex clients_mutex;                      // Mutex pour l'ensemble des clients
     int server_fd;                                 // Descripteur de socket serveur
-    std::mutex log_mutex;                          // Mutex pour les logs
     std::atomic<bool> running;                     // Indique si le serveur est actif
 
 public:
+    // Coût estimé (voir Session::analysisCost) au-delà duquel une analyse quitte les threads
+    // d'entrée/sortie pour le pool de calcul, quand le serveur en a un.
+    static constexpr uint64_t INLINE_ANALYSIS_COST = 4096;
+
     Server(const std::string& addr, int p)
         : port(p), address(addr), server_fd(-1), running(false) {
         if (port <= 0 || port > 65535) {
@@ -31,7 +37,7 @@ public:
         }
     }
 
-    ~Server() {stop();}
+    virtual ~Server() {stop();}
 
     // Méthodes abstraites pour l'extension
     virtual void start() = 0;
@@ -47,20 +53,22 @@ public:
 
     // Gestion des clients
     virtual bool addClient(int clientID) {
+        std::lock_guard<std::mutex> lock(clients_mutex);
         if (connectedClients.find(clientID) != connectedClients.end()) {
-            log("[Server] Client " + std::to_string(clientID) + " is already connected.");
+            LOG_WARNING("[Server] Client ", clientID, " is already connected.");
             return false;
         }
         connectedClients.insert(clientID);
-        log("[Server] Client " + std::to_string(clientID) + " connected.");
+        LOG_DEBUG("[Server] Client ", clientID, " connected.");
         return true;
     }
     virtual bool removeClient(int clientID) {
+        std::lock_guard<std::mutex> lock(clients_mutex);
         if (connectedClients.erase(clientID)) {
-            log("[Server] Client " + std::to_string(clientID) + " disconnected.");
+            LOG_DEBUG("[Server] Client ", clientID, " disconnected.");
             return true;
         }
-        log("[Server] Client " + std::to_string(clientID) + " not found.");
+        LOG_WARNING("[Server] Client ", clientID, " not found.");
         return false;
     }
 
@@ -88,7 +96,8 @@ protected:
             throw std::runtime_error("[Server] Bind failed.");
         }
 
-        if (listen(server_fd, 10) < 0) {
+        // File d'attente maximale : des milliers de clients peuvent se connecter en rafale.
+        if (listen(server_fd, SOMAXCONN) < 0) {
             closeSocket();
             throw std::runtime_error("[Server] Listen failed.");
         }
@@ -97,15 +106,16 @@ protected:
     }
     void closeSocket() {
         if (server_fd >= 0) {
+            shutdown(server_fd, SHUT_RDWR); // Débloque un accept() en cours dans un autre thread.
             close(server_fd);
             log("[Server] Socket closed.");
             server_fd = -1;
         }
     }
 
+    // Journalise au niveau Info via le journal asynchrone (voir Logger.hpp).
     virtual void log(const std::string& message) {
-        std::lock_guard<std::mutex> lock(log_mutex);
-        std::cout << message << std::endl;
+        ::log(message);
     }
 };
 
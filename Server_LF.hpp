@@ -1,18 +1,59 @@
-#include <thread>
-#include <sstream>
+#ifndef SERVER_LF_HPP
+#define SERVER_LF_HPP
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
 #include "Server.hpp"                // Inclut la classe abstraite Server.
 #include "LeaderFollowers.hpp"       // Inclut la classe Leader-Followers pour gérer les threads.
-#include "../../src/Model/Graph.hpp" // Inclut la classe Graph pour représenter les graphes.
+#include "FairQueue.hpp"             // Ordre de service équitable des sessions.
+#include "WorkerPool.hpp"            // Pool de calcul des grosses analyses.
+#include "Session.hpp"               // Inclut l'état d'une session client (graphe, commandes).
 
 /**
  * @brief Server_LF class - Implements a server based on the Leader-Followers pattern.
  *
- * This class extends the abstract `Server` class and uses a thread pool
- * to asynchronously manage client connections and requests.
+ * This class extends the abstract `Server` class. The listening socket and every client socket
+ * belong to the handle set of the Leader-Followers pool: the leader thread waits for an event,
+ * promotes a follower, then accepts the new clients or runs the commands of the client itself.
+ * No thread is tied to a client, and the main thread does not take part in accepting clients.
+ *
+ * Sessions with complete commands wait in a fair queue rather than in the pool's task queues: each
+ * pool task serves the session whose turn it is (deficit round robin on the estimated cost of its
+ * next command), so a client flooding the server with large analyses gets its share of the threads
+ * while the short commands of the other clients go between its MST computations.
+ *
+ * Client sockets are non-blocking, so a thread never waits on a client that does not read its
+ * replies: the unsent replies stay in the session's output and its socket is watched for
+ * writability (EPOLLOUT) instead of input; the session goes back to the fair queue once it can send
+ * again. No new command of that client is run while OUTPUT_DRAIN_LIMIT bytes of replies are waiting.
+ *
+ * Bulkhead: with a compute pool (`compute_threads` > 0), an analysis estimated above
+ * INLINE_ANALYSIS_COST runs on the compute pool rather than on the Leader-Followers threads, which
+ * only accept connections, read input, run the short commands and send the replies. Once the
+ * analysis is in the session's output, the session goes back to the fair queue. Large MST solves
+ * then saturate the compute pool without taking the threads that watch the sockets. Without a
+ * compute pool, the metric sections of such an analysis are computed in parallel on the pool
+ * itself (`parallel_for`), the serving thread taking part while it waits. Background
+ * jobs (`solve async`, see SolveJobs) run there too, or on the pool's threads without a compute pool.
+ * They stop at the solver's next checkpoint when their client disconnects or the server stops.
  */
 class Server_LF : public Server { // Hérite de la classe Server.
 private:
+    std::unordered_map<int, std::unique_ptr<Session>> sessions; // Sessions des clients connectés.
+    std::mutex sessions_mutex;                                  // Protège `sessions` (pas les sessions elles-mêmes).
+    std::mutex stop_mutex;                                      // Protège l'attente de `start`.
+    std::condition_variable stopped;                            // Signalée par `stop`.
+    FairQueue<int, int> ready;                                  // Sockets des sessions ayant des commandes en attente.
+    std::mutex ready_mutex;                                     // Protège `ready`.
     LeaderFollowers thread_pool; // Pool de threads basé sur le modèle Leader-Followers.
+    WorkerPool compute;          // Pool des grosses analyses (vide si compute_threads == 0).
+    int compute_threads;         // Taille du pool de calcul (0 : analyses sur le pool Leader-Followers).
 
 public:
 
@@ -24,24 +65,41 @@ public:
      *
      * @param addr The IP address or hostname on which the server listens.
      * @param port The port on which the server listens for connections.
-     * @param num_threads The number of threads in the Leader-Followers thread pool.
+     * @param num_threads The number of threads in the Leader-Followers thread pool (its minimum when elastic).
+     * @param cpus Cores of the pool threads, which also accept the connections (empty: not pinned).
+     * @param max_threads Upper bound of an elastic pool, which adds threads while requests wait behind
+     *        busy or blocked threads and retires idle ones (0 or `num_threads`: fixed size).
+     * @param compute_threads Threads of the compute pool for large analyses, pinned after the pool
+     *        threads (0: analyses run on the Leader-Followers threads).
      */
-    Server_LF(const std::string& addr, int port, int num_threads) : Server(addr, port), thread_pool(num_threads) {
+    Server_LF(const std::string& addr, int port, int num_threads, CpuPlacement cpus = {}, int max_threads = 0,
+              int compute_threads = 0)
+        : Server(addr, port),
+          thread_pool(num_threads, std::max(num_threads, max_threads),
+                      [this](int fd, uint32_t events) { handleEvent(fd, events); },
+                      cpus.take(static_cast<size_t>(std::max(num_threads, max_threads)))),
+          // Sans borne : une session a au plus une analyse dans le pool de calcul.
+          compute(compute_threads, 0, cpus.take(static_cast<size_t>(std::max(compute_threads, 0)))),
+          compute_threads(std::max(compute_threads, 0)) {
         // Initialise le serveur et le pool de threads.
         setupServerSocket(); // Configure le socket du serveur.
+        fcntl(server_fd, F_SETFL, fcntl(server_fd, F_GETFL, 0) | O_NONBLOCK); // accept() ne bloque jamais le leader.
         log("[Server_LF] Server configured on " + address + ":" + std::to_string(port)); // Journalise l'adresse et le port.
+        if (cpus.enabled()) LOG_INFO("[Server_LF] Threads pinned to CPUs ", formatCpuList(cpus.cpus()), ".");
+        if (max_threads > num_threads) LOG_INFO("[Server_LF] Elastic pool: ", num_threads, " to ", max_threads, " threads.");
+        if (compute_threads > 0) LOG_INFO("[Server_LF] Compute pool: ", compute_threads, " thread(s).");
+    }
+
+    ~Server_LF() {
+        stop();
     }
 
     /**
      * @brief Starts the Leader-Followers server.
      *
-     * This method enables the server, accepts incoming connections, and delegates their management
-     * to a thread pool based on the Leader-Followers model.
-     *
-     * - If the server is already running, it will not start again.
-     * - Each client connection is handled by adding tasks to the thread pool.
-     *
-     * @throws std::exception If a critical error occurs during execution.
+     * Adds the listening socket to the handle set of the thread pool: from then on, the leader thread
+     * accepts the connections, while the calling thread only waits for `stop`.
+     * If the server is already running, it will not start again.
      */
     void start() override {
         // Vérifie si le serveur est déjà en cours d'exécution.
@@ -50,177 +108,275 @@ public:
             return; // Évite les redémarrages multiples.
         }
 
+        thread_pool.watch(server_fd, EPOLLIN);
         log("[Server_LF] Server started."); // Journalise que le serveur a démarré.
 
-        // Boucle principale pour accepter les connexions tant que le serveur est actif.
-        while (running) {
-            sockaddr_in client_addr{}; // Structure pour stocker les informations sur le client.
-            socklen_t client_len = sizeof(client_addr); // Taille de la structure `sockaddr_in`.
-            // Accepte une connexion client.
-            int client_socket = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-            // Si l'appel à `accept` échoue.
-            if (client_socket < 0) {
-                if (running) { // Vérifie que le serveur est toujours actif.
-                    log("[Server_LF] Failed to accept connection."); // Journalise l'erreur.
-                }
-                continue; // Continue avec la prochaine itération.
-            }
-            log("[Server_LF] New client connected: " + std::to_string(client_socket)); // Journalise la connexion d'un nouveau client.
-            // Ajoute le client à la liste des clients connectés.
-            if (!addClient(client_socket)) { // Si l'ajout échoue.
-                close(client_socket); // Ferme le socket pour éviter une fuite de ressources.
-                continue;
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        stopped.wait(lock, [this]() { return !running; });
+    }
+
+    /**
+     * @brief Stops the server, its thread pool, and closes the remaining client connections.
+     */
+    void stop() override {
+        bool wasRunning;
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            wasRunning = running.exchange(false);
+        }
+        stopped.notify_all();
+        {
+            // Les calculs d'ACM en cours s'arrêtent à leur prochain point de contrôle.
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            for (auto& entry : sessions) entry.second->cancelComputations();
+        }
+        thread_pool.stop(); // Réveille le leader par son eventfd et attend la fin des traitements en cours.
+        compute.stop();     // Et celle des analyses, qui accèdent aux sessions.
+
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            for (auto& entry : sessions) {
+                removeClient(entry.first);
+                close(entry.first);
             }
-            // Ajoute une tâche au pool de threads pour gérer la connexion client.
-            thread_pool.add_task([this, client_socket]() {
-                handleClient(client_socket); // Gère les interactions avec le client.
-            });
+            sessions.clear();
         }
+        // Plus aucun thread ne peut accepter sur le socket d'écoute : il peut être fermé.
+        closeSocket();
+        log(wasRunning ? "[Server] Server stopped." : "[Server] Server is already stopped.");
     }
 
     /**
-     * @brief Handles interactions with a client.
+     * @brief Handles an event of a client socket (called by the thread that received it).
      *
-     * Reads commands sent by the client, performs operations on the graph,
-     * and sends responses back to the client.
+     * Reads the available input into the session, then runs its first command(s). The graph is
+     * only analyzed when the session asks for it (explicit 'analyze' or automatic analysis
+     * interval). See `serveClient` for what happens to the remaining commands.
      *
      * @param client_socket The client's socket descriptor.
      */
     void handleClient(int client_socket) override {
-        std::unique_ptr<Graph> graph; // Pointeur unique pour gérer dynamiquement le graphe associé à ce client.
-
-        // Prépare le menu d'aide à envoyer au client.
-        std::string helpMenu = "------------------------ COMMAND MENU --------------------------------------------\n";
-        helpMenu += "Create a new graph:\n   - Syntax: 'create <number_of_vertices>'\n";
-        helpMenu += "Add an edge:\n   - Syntax: 'add <u> <v> <w>'\n";
-        helpMenu += "Remove an edge:\n   - Syntax: 'remove <u> <v>'\n";
-        helpMenu += "Choose MST Algorithm:\n   - Syntax: 'algo <algorithm_name>'\n     (prim/kruskal/tarjan/boruvka/integer_mst)\n" ;
-        helpMenu += "Shutdown:\n   - Syntax: 'shutdown'\n";
-        helpMenu += "----------------------------------------------------------------------------------\n";
-
-        send(client_socket, helpMenu.c_str(), helpMenu.size(), 0); // Envoie le menu d'aide au client.
-
-        char buffer[1024]; // Tampon pour recevoir les commandes du client.
-        while (running) { // Tant que le serveur est actif.
-            int bytesRead = read(client_socket, buffer, sizeof(buffer)); // Lit les données envoyées par le client.
-            if (bytesRead <= 0) { // Si le client se déconnecte ou s'il y a une erreur.
-                std::cout << "Client disconnected.\n";
+        Session* session = findSession(client_socket);
+        if (!session) return;
+
+        char buffer[4096]; // Tampon pour recevoir les commandes du client.
+        // Au-delà de MAX_LINE_LENGTH octets en attente, le reste est laissé dans le socket : le réarmement
+        // (déclenché par niveau) le relira une fois ces commandes servies.
+        while (session->pendingInput() <= Session::MAX_LINE_LENGTH) {
+            ssize_t bytesRead = recv(client_socket, buffer, sizeof(buffer), MSG_DONTWAIT); // Lit les données disponibles.
+            if (bytesRead > 0) {
+                if (!session->feed(buffer, static_cast<size_t>(bytesRead))) break; // Commande trop longue.
+                continue;
+            }
+            if (bytesRead < 0 && errno == EINTR) continue;
+            // Fin de l'entrée : les commandes déjà reçues sont servies avant la fermeture.
+            if (bytesRead == 0) {
+                session->closeInput();
                 break;
             }
-
-            // Traite la commande reçue.
-            std::string request(buffer, bytesRead); // Convertit les données reçues en chaîne.
-            std::stringstream ss(request); // Crée un flux à partir de la commande.
-            std::string command;
-            ss >> command; // Extrait la commande principale.
-
-            if (command == "create") {
-                std::string token;
-                if (ss >> token) { // Vérifier si un argument est fourni après "create".
-                    try {
-                        int size = std::stoi(token); // Convertir l'argument en entier.
-                        if (size < 0) {
-                            std::string response = "Error: Number of vertices must be greater than or equal to 0.\n";
-                            send(client_socket, response.c_str(), response.size(), 0);
-                        } else {
-                            graph = std::make_unique<Graph>(size); // Créer ou réinitialiser le graphe.
-                            std::string response = "Graph created with " + std::to_string(size) + " vertices.\n";
-                            send(client_socket, response.c_str(), response.size(), 0);
-                        }
-                    } catch (const std::invalid_argument&) {
-                        // Si l'argument n'est pas un entier valide.
-                        std::string response = "Invalid input. Syntax: 'create <number_of_vertices>'\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    } catch (const std::out_of_range&) {
-                        // Si l'entier est trop grand ou trop petit.
-                        std::string response = "Error: Number out of range.\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    }
-                } else {
-                    // Aucun argument fourni : ne fait rien et indique l'erreur.
-                    std::string response = "Error: Number of vertices not provided. Syntax: 'create <number_of_vertices>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
+            // Une erreur s'est produite.
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeClient(client_socket);
+                return;
             }
-            else if (command == "add") {
-                if (!graph) {
-                    std::string response = "Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue;
-                }
-                int u, v, weight;
-                if (ss >> u >> v >> weight) {
-                    graph->add_edge(u, v, weight);
-                    std::string response = "Edge added: (" + std::to_string(u) + ", " + std::to_string(v) + ") with weight " + std::to_string(weight) + "\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                } else {
-                    std::string response = "Invalid input. Syntax: 'add <u> <v> <w>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
+            break;
+        }
+        if (!session->hasCommand()) {
+            serveClient(client_socket, session); // Commande incomplète : réarme (ou ferme) le socket.
+            return;
+        }
+        // Ce thread sert la session dont c'est le tour, pas forcément celle-ci.
+        enqueue(client_socket, *session);
+        serveNext();
+    }
+
+private:
+    // Commandes exécutées par tâche : une session occupe un thread le temps d'une commande, pas d'une connexion.
+    static constexpr int COMMANDS_PER_TASK = 1;
+
+    Session* findSession(int client_socket) {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        auto it = sessions.find(client_socket);
+        return it == sessions.end() ? nullptr : it->second.get();
+    }
+
+    // Queues the session (disarmed, so no other thread touches it) behind the other waiting sessions.
+    void enqueue(int client_socket, const Session& session) {
+        std::lock_guard<std::mutex> lock(ready_mutex);
+        ready.push(client_socket, client_socket, session.nextCommandCost());
+    }
+
+    // Serves the session whose turn it is, if any (one call per `enqueue`).
+    void serveNext() {
+        int client_socket;
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            if (ready.empty()) return;
+            client_socket = ready.pop();
+        }
+        if (Session* session = findSession(client_socket)) serveClient(client_socket, session);
+    }
+
+    /*
+     * Runs up to COMMANDS_PER_TASK commands of the session (none while its replies are backlogged)
+     * and sends the responses. The session then resumes from where it stopped: if the socket is full,
+     * it is re-armed for writability only; if complete commands remain, the session goes back to the
+     * fair queue and a task is added to serve the next session due (the socket stays disarmed
+     * meanwhile, so no other thread touches the session); otherwise the socket is re-armed for the
+     * next input, or closed.
+     */
+    void serveClient(int client_socket, Session* session) {
+        // Les réponses que le client n'a pas encore lues retiennent ses commandes suivantes.
+        bool backlogged = session->output.size() >= Session::OUTPUT_DRAIN_LIMIT;
+        Session::Progress progress = session->resume(backlogged ? 0 : COMMANDS_PER_TASK, INLINE_ANALYSIS_COST);
+        if (progress == Session::Progress::Analyze) {
+            if (compute_threads > 0 && analyzeAsync(client_socket, *session)) return;
+            // Sans pool de calcul (ou pool arrêté) : l'analyse est répartie sur le pool Leader-Followers.
+            analyzeOnPool(*session);
+            progress = session->hasCommand() ? Session::Progress::Pending : Session::Progress::Idle;
+        }
+        if (!session->flush()) progress = Session::Progress::Closed;
+
+        if (progress == Session::Progress::Closed || !running) {
+            closeClient(client_socket);
+        } else if (!session->output.empty()) {
+            // Socket plein : la session attend qu'il redevienne inscriptible (voir handleEvent).
+            thread_pool.rearm(client_socket, EPOLLOUT);
+        } else if (progress == Session::Progress::Idle && session->inputClosed()) {
+            // Un client qui a fermé son côté n'enverra plus de commande : fermé une fois servi.
+            closeClient(client_socket);
+        } else if (progress == Session::Progress::Pending) {
+            enqueue(client_socket, *session);
+            thread_pool.add_task([this]() { serveNext(); });
+        } else {
+            session->output.releaseSpares(); // Un client en attente ne garde aucun bloc de sortie.
+            thread_pool.rearm(client_socket, EPOLLIN | EPOLLRDHUP); // Attend la prochaine commande.
+        }
+    }
+
+    // Runs the session's pending analysis on the compute pool, then queues the session again (its
+    // socket stays disarmed, so only the compute thread touches it meanwhile, without sending: the
+    // thread that serves the session next sends the analysis). Returns false if the compute pool
+    // refused the analysis (stopping).
+    bool analyzeAsync(int client_socket, Session& session) {
+        session.holdOutput(true);
+        bool submitted = compute.submit(client_socket, session.analysisCost(), [this, client_socket]() {
+            Session* session = findSession(client_socket);
+            if (!session) return;
+            session->writeAnalysis();
+            session->holdOutput(false);
+            enqueue(client_socket, *session);
+            thread_pool.add_task([this]() { serveNext(); });
+        });
+        if (!submitted) session.holdOutput(false);
+        return submitted;
+    }
+
+    // Sections d'analyse indépendantes, lues sur le même ACM : calculées en parallèle par `analyzeOnPool`.
+    static constexpr AnalysisMetric PARALLEL_SECTIONS[] = {ANALYSIS_WEIGHT, ANALYSIS_AVERAGE, ANALYSIS_DEPTH,
+                                                           ANALYSIS_HEAVIEST_PATH, ANALYSIS_MAX_EDGE, ANALYSIS_MIN_EDGE};
+
+    // Writes the session's pending analysis from this pool thread: the MST is solved first, then its
+    // sections are computed (and memoized in the graph) by one task each, the calling thread running
+    // some of them while it waits, and the analysis is written from the memoized sections.
+    void analyzeOnPool(Session& session) {
+        if (session.pagePending()) { // Page de `show mst` : seul l'ACM est à calculer.
+            session.writeAnalysis();
+            return;
+        }
+        Graph& graph = *session.graph;
+        if (session.metrics & ~ANALYSIS_GRAPH) {
+            try {
+                graph.Solve(session.beginSolve());
+            } catch (const OperationCancelled& reason) {
+                session.replyCancelled(reason);
+                return;
             }
-            else if (command == "remove") {
-                if (!graph) {
-                    std::string response = "Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue;
-                }
-                int u, v;
-                if (ss >> u >> v) {
-                    graph->remove_edge(u, v);
-                    std::string response = "Edge removed: (" + std::to_string(u) + ", " + std::to_string(v) + ")\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                } else {
-                    std::string response = "Invalid input. Syntax: 'remove <u> <v>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
+        }
+        std::vector<AnalysisMetric> sections;
+        unsigned available = graph.getAvailableSections(session.metrics);
+        for (AnalysisMetric metric : PARALLEL_SECTIONS) {
+            if (available & metric) sections.push_back(metric);
+        }
+        bool binary = session.binary;
+        // Chaque section a sa propre entrée dans le cache du graphe : les tâches ne se gênent pas.
+        thread_pool.parallel_for<size_t>(0, sections.size(), [&graph, &sections, binary](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                if (binary) graph.getBinarySection(sections[i]);
+                else graph.getAnalysisSection(sections[i]);
             }
-            else if (command == "algo") {
-                if (!graph) {
-                    log("[Server] Graph not initialized when trying to set algorithm.");
-                    std::string response = "Error: Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue; // Continue to the next iteration of the loop
-                }
+        }, 1);
+        session.writeAnalysis();
+    }
 
-                log("[Server] Received 'algo' command.");
-                std::string selectedAlgorithm;
-                if (ss >> selectedAlgorithm) {
-                    log("[Server] Algorithm selected: " + selectedAlgorithm);
-                    if (selectedAlgorithm == "prim" || selectedAlgorithm == "kruskal" ||
-                        selectedAlgorithm == "boruvka" || selectedAlgorithm == "tarjan" ||
-                        selectedAlgorithm == "integer_mst") {
-                        graph->_algorithmChoice = selectedAlgorithm;
-                        log("[Server] Algorithm set successfully.");
-                        std::string response = "Algorithm set to " + selectedAlgorithm + ".\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                        } else {
-                            log("[Server] Unknown algorithm: " + selectedAlgorithm);
-                            std::string response = "Error: Unknown algorithm '" + selectedAlgorithm + "'.\n";
-                            send(client_socket, response.c_str(), response.size(), 0);
-                        }
-                } else {
-                    log("[Server] Invalid 'algo' command syntax.");
-                    std::string response = "Invalid input. Syntax: 'algo <algorithm_name>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
+    void closeClient(int client_socket) {
+        thread_pool.unwatch(client_socket);
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            sessions.erase(client_socket);
+        }
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            ready.forget(client_socket);
+        }
+        removeClient(client_socket);
+        close(client_socket); // Ferme la connexion client.
+    }
+
+    // Répartit un événement de l'ensemble surveillé : nouvelle connexion, socket client de nouveau
+    // inscriptible (la session reprend son tour dans la file) ou commande d'un client.
+    void handleEvent(int fd, uint32_t events) {
+        if (fd == server_fd) {
+            acceptClients();
+        } else if (events & EPOLLOUT) {
+            Session* session = findSession(fd);
+            if (!session) return;
+            enqueue(fd, *session);
+            serveNext();
+        } else {
+            handleClient(fd);
+        }
+    }
+
+    // Accepte toutes les connexions en attente, puis réarme le socket d'écoute.
+    void acceptClients() {
+        while (running) {
+            // Non bloquant : un client qui ne lit pas ses réponses ne retient aucun thread.
+            int client_socket = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (client_socket < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running) {
+                    LOG_ERROR("[Server_LF] Failed to accept connection."); // Journalise l'erreur.
                 }
-            }
-            else if (command == "shutdown") {
-                std::string response = "Shutting down client.\n";
-                send(client_socket, response.c_str(), response.size(), 0);
                 break;
             }
-            else {
-                std::string response = "Unknown command. Use 'help' for a list of commands.\n";
-                send(client_socket, response.c_str(), response.size(), 0);
-            }
-            if (graph) {
-                send(client_socket, graph->Analysis().c_str(), graph->Analysis().size(), 0);
+            LOG_DEBUG("[Server_LF] New client connected: ", client_socket); // Journalise la connexion d'un nouveau client.
+            // Ajoute le client à la liste des clients connectés.
+            if (!addClient(client_socket)) { // Si l'ajout échoue.
+                close(client_socket); // Ferme le socket pour éviter une fuite de ressources.
+                continue;
             }
 
+            auto session = std::make_unique<Session>(client_socket); // État du client : graphe, réglages et tampons.
+            // Les travaux `solve async` tournent sur le pool de calcul, à défaut sur le pool Leader-Followers.
+            session->setJobExecutor([this, client_socket](UniqueTask job, uint64_t cost) {
+                if (compute_threads > 0) return compute.submit(client_socket, cost, std::move(job));
+                thread_pool.add_task(std::move(job));
+                return true;
+            });
+            session->output << Session::helpMenu();
+            session->flush(); // Envoie le menu d'aide au client.
+            // Menu pas entièrement envoyé : la suite part dès que le socket est inscriptible.
+            uint32_t events = session->output.empty() ? EPOLLIN | EPOLLRDHUP : EPOLLOUT;
+            session->output.releaseSpares();
+            {
+                std::lock_guard<std::mutex> lock(sessions_mutex);
+                sessions[client_socket] = std::move(session);
+            }
+            thread_pool.watch(client_socket, events);
         }
-
-        close(client_socket); // Ferme la connexion client.
-        std::cout << "Client socket closed.\n"; // Indique que le socket est fermé.
+        if (running) thread_pool.rearm(server_fd, EPOLLIN);
     }
+};
 
-};
\ No newline at end of file
+#endif // SERVER_LF_HPP
@@ -1,236 +1,167 @@
 #ifndef SERVER_PL_HPP
 #define SERVER_PL_HPP
 
-#include <thread>       // For creating and managing threads.
-#include <sstream>      // For parsing client input commands.
-#include "Server.hpp"   // Base server class.
-#include "Pipeline.hpp" // Pipeline for task execution.
-#include "../../src/Model/Graph.hpp" // Graph model used for MST operations.
+#include <string>        // For the analysis text.
+#include "Server_RE.hpp" // Event loop, worker pool and admission control.
+#include "Pipeline.hpp"  // Pipeline for task execution.
+#include "Session.hpp"   // Client session state and command parsing.
 
 /**
  * @class Server_PL
  * @brief Implements a server using the Pipeline design pattern.
+ *
+ * Connections are handled like in Server_RE: one event loop, a fixed pool of workers shared by
+ * all the clients and admission control when they are saturated, instead of a thread per client.
+ * The analyses requested by the sessions are computed by one analysis pipeline, built and started
+ * with the server: its stages keep their threads for the server's lifetime and every request
+ * travels through them, so requests from different clients overlap in different stages.
+ *
+ * The pipeline is also the server's compute pool: a large analysis is submitted to it without the
+ * worker waiting for the result (see Server_RE::analyzeAsync), so the workers keep serving short
+ * commands while the stages compute. Smaller analyses still wait for their result on the worker.
+ *
+ * The metric sections are independent reads of the same MST, so the pipeline is a small DAG:
+ * a Solve stage, then the metric stages in parallel, joined by a formatter stage. The latency of
+ * an analysis is that of its slowest metric stage instead of the sum of all of them.
  */
-class Server_PL : public Server {
+class Server_PL : public Server_RE {
 public:
-    // Constructor to initialize the server with an address and port.
-    Server_PL(const std::string& addr, int port) : Server(addr, port) {
-        setupServerSocket(); // Sets up the server socket for communication.
+    // Constructor to initialize the server with an address, port and number of worker threads.
+    // With a CPU placement, each pipeline thread gets the next core after the workers and the event
+    // loop: one core per stage (and per branch) as long as there are enough of them.
+    Server_PL(const std::string& addr, int port, int num_threads, CpuPlacement cpus = {})
+        : Server_RE(addr, port, num_threads, DEFAULT_MAX_CLIENTS, std::move(cpus)), pipeline(STAGE_QUEUE_CAPACITY, ActiveObject::OverflowPolicy::Block) {
+        buildPipeline();
         log("[Server_PL] Server configured on " + address + ":" + std::to_string(port)); // Logs configuration.
     }
 
-    // Starts the server and handles incoming client connections.
-    void start() override {
-        // Ensures the server isn't started multiple times.
-        if (running.exchange(true)) {
-            log("[Server_PL] Server is already running.");
-            return;
+    // The workers must be done with the pipeline before its stages are destroyed.
+    ~Server_PL() {
+        stop();
+        pipeline.stop();
+        for (size_t i = 0; i < pipeline.stageCount(); ++i) {
+            log("[Server_PL] Stage " + std::to_string(i) + " queue high-water mark: " + std::to_string(pipeline.highWaterMark(i)));
         }
+    }
 
-        log("[Server_PL] Server started.");
-
-        // Main loop to handle incoming client connections.
-        while (running) {
-            sockaddr_in client_addr{}; // Stores client address information.
-            socklen_t client_len = sizeof(client_addr);
-            int client_socket = accept(server_fd, (struct sockaddr*)&client_addr, &client_len); // Accepts client connections.
+protected:
+    // Runs the pipeline for the requested sections, in the session's response format.
+    void analyze(Session& session) override {
+        try {
+            writeResult(session, pipeline.execute(job(session)));
+        } catch (const OperationCancelled& reason) {
+            session.replyCancelled(reason);
+        }
+    }
 
-            // If accepting a connection fails, log the error and continue.
-            if (client_socket < 0) {
-                if (running) {
-                    log("[Server_PL] Failed to accept connection.");
+    // Submits the analysis to the pipeline; the last stage writes the result and calls `done`.
+    // The stage thread only appends to the session's output: the worker resumed by `done` sends it.
+    bool analyzeAsync(Session& session, UniqueTask done) override {
+        auto finish = std::make_shared<UniqueTask>(std::move(done)); // The pipeline callbacks are copyable.
+        session.holdOutput(true);
+        pipeline.submit(
+            job(session),
+            [&session, finish](AnalysisResult result) {
+                writeResult(session, result);
+                session.holdOutput(false);
+                (*finish)();
+            },
+            [&session, finish](std::exception_ptr error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const OperationCancelled& reason) {
+                    session.replyCancelled(reason);
+                } catch (...) {
+                    session.reply("Error: analysis failed.\n");
                 }
-                continue;
-            }
-
-            log("[Server_PL] New client connected: " + std::to_string(client_socket)); // Logs client connection.
-
-            // If the client is not added successfully, close the connection.
-            if (!addClient(client_socket)) {
-                close(client_socket);
-                continue;
-            }
+                session.holdOutput(false);
+                (*finish)();
+            });
+        return true;
+    }
 
-            // Handles client communication in a separate thread.
-            std::thread(&Server_PL::handleClient, this, client_socket).detach();
-        }
+private:
+    // Input of a pipeline request: the sections of `graph` to write, as text or as binary sections.
+    struct AnalysisJob {
+        Graph* graph;
+        unsigned metrics;
+        bool binary;
+        CancellationToken* token; // Stops the Solve stage (session closed or deadline passed).
+        bool solveOnly;           // A 'show mst' page waits for the MST: no section to compute.
+    };
+
+    static AnalysisJob job(Session& session) {
+        return AnalysisJob{session.graph.get(), session.metrics, session.binary, session.beginSolve(), session.pagePending()};
     }
 
-    // Handles communication with an individual client.
-    void handleClient(int client_socket) override {
-        std::unique_ptr<Graph> graph; // Unique pointer for dynamically managing the graph for this client.
-
-        // Help menu to display available commands to the client.
-        std::string helpMenu = "------------------------ COMMAND MENU --------------------------------------------\n";
-        helpMenu += "Create a new graph:\n   - Syntax: 'create <number_of_vertices>'\n";
-        helpMenu += "Add an edge:\n   - Syntax: 'add <u> <v> <w>'\n";
-        helpMenu += "Remove an edge:\n   - Syntax: 'remove <u> <v>'\n";
-        helpMenu += "Choose MST Algorithm:\n   - Syntax: 'algo <algorithm_name>'\n     (prim/kruskal/tarjan/boruvka/integer_mst)\n" ;
-        helpMenu += "Shutdown:\n   - Syntax: 'shutdown'\n";
-        helpMenu += "----------------------------------------------------------------------------------\n";
-
-        // Sends the help menu to the client.
-        send(client_socket, helpMenu.c_str(), helpMenu.size(), 0);
-
-        char buffer[1024]; // Buffer to store commands from the client.
-
-        // Continuously processes client commands while the server is running.
-        while (running) {
-            int bytesRead = read(client_socket, buffer, sizeof(buffer)); // Reads data from the client.
-            if (bytesRead <= 0) { // Handles client disconnection or errors.
-                std::cout << "Client disconnected.\n";
-                break;
-            }
+    // Result of a pipeline request: the sections actually available and their concatenation.
+    struct AnalysisResult {
+        unsigned sections = 0;
+        std::string payload;
+    };
+
+    static void writeResult(Session& session, const AnalysisResult& result) {
+        // The MST is up to date: writing the page does not solve it again.
+        if (session.pagePending()) session.writeAnalysis();
+        else if (!session.binary) session.output << result.payload;
+        else session.writeAnalysisFrame(result.sections, result.payload);
+    }
 
-            std::string request(buffer, bytesRead); // Converts the received data into a string.
-            std::stringstream ss(request);         // Parses the client command.
-            std::string command;
-            ss >> command;                         // Extracts the main command.
-
-            // Handles the 'create' command for initializing a graph.
-            if (command == "create") {
-                std::string token;
-                if (ss >> token) { // Checks if the number of vertices is provided.
-                    try {
-                        int size = std::stoi(token); // Converts the token to an integer.
-                        if (size < 0) {             // Validates the number of vertices.
-                            std::string response = "Error: Number of vertices must be greater than or equal to 0.\n";
-                            send(client_socket, response.c_str(), response.size(), 0);
-                        } else {
-                            graph = std::make_unique<Graph>(size); // Creates or resets the graph.
-                            std::string response = "Graph created with " + std::to_string(size) + " vertices.\n";
-                            send(client_socket, response.c_str(), response.size(), 0);
-                        }
-                    } catch (const std::invalid_argument&) { // Handles invalid input.
-                        std::string response = "Invalid input. Syntax: 'create <number_of_vertices>'\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    } catch (const std::out_of_range&) { // Handles out-of-range values.
-                        std::string response = "Error: Number out of range.\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    }
-                } else { // Handles missing arguments.
-                    std::string response = "Error: Number of vertices not provided. Syntax: 'create <number_of_vertices>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
-            }
-            // Handles the 'add' command to add an edge to the graph.
-            else if (command == "add") {
-                if (!graph) { // Ensures a graph is created before adding edges.
-                    std::string response = "Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue;
-                }
-                int u, v, weight;
-                if (ss >> u >> v >> weight) { // Extracts edge details.
-                    graph->add_edge(u, v, weight); // Adds the edge to the graph.
-                    std::string response = "Edge added: (" + std::to_string(u) + ", " + std::to_string(v) + ") with weight " + std::to_string(weight) + "\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                } else { // Handles invalid syntax.
-                    std::string response = "Invalid input. Syntax: 'add <u> <v> <w>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
-            }
-            // Handles the 'remove' command to remove an edge from the graph.
-            else if (command == "remove") {
-                if (!graph) { // Ensures a graph exists.
-                    std::string response = "Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue;
-                }
-                int u, v;
-                if (ss >> u >> v) { // Extracts edge details.
-                    graph->remove_edge(u, v); // Removes the edge from the graph.
-                    std::string response = "Edge removed: (" + std::to_string(u) + ", " + std::to_string(v) + ")\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                } else { // Handles invalid syntax.
-                    std::string response = "Invalid input. Syntax: 'remove <u> <v>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
-            }
-            // Handles the 'algo' command to select an MST algorithm.
-            else if (command == "algo") {
-                if (!graph) { // Ensures a graph exists.
-                    log("[Server] Graph not initialized when trying to set algorithm.");
-                    std::string response = "Error: Graph not created. Use 'create' first.\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                    continue;
-                }
+    // Requests waiting at each stage. A full stage blocks the stage (or worker) feeding it, so a slow
+    // stage ends up filling the workers' queue, where admission control rejects new commands.
+    static constexpr size_t STAGE_QUEUE_CAPACITY = 64;
 
-                log("[Server] Received 'algo' command.");
-                std::string selectedAlgorithm;
-                if (ss >> selectedAlgorithm) { // Extracts the algorithm name.
-                    log("[Server] Algorithm selected: " + selectedAlgorithm);
-                    if (selectedAlgorithm == "prim" || selectedAlgorithm == "kruskal" ||
-                        selectedAlgorithm == "boruvka" || selectedAlgorithm == "tarjan" ||
-                        selectedAlgorithm == "integer_mst") {
-                        graph->_algorithmChoice = selectedAlgorithm; // Sets the algorithm.
-                        log("[Server] Algorithm set successfully.");
-                        std::string response = "Algorithm set to " + selectedAlgorithm + ".\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    } else { // Handles invalid algorithms.
-                        log("[Server] Unknown algorithm: " + selectedAlgorithm);
-                        std::string response = "Error: Unknown algorithm '" + selectedAlgorithm + "'.\n";
-                        send(client_socket, response.c_str(), response.size(), 0);
-                    }
-                } else { // Handles missing algorithm name.
-                    log("[Server] Invalid 'algo' command syntax.");
-                    std::string response = "Invalid input. Syntax: 'algo <algorithm_name>'\n";
-                    send(client_socket, response.c_str(), response.size(), 0);
-                }
-            }
-            // Handles the 'shutdown' command to disconnect the client.
-            else if (command == "shutdown") {
-                std::string response = "Shutting down client.\n";
-                send(client_socket, response.c_str(), response.size(), 0);
-                break;
-            }
-            // Handles unknown commands.
-            else {
-                std::string response = "Unknown command. Use 'help' for a list of commands.\n";
-                send(client_socket, response.c_str(), response.size(), 0);
-            }
+    using AnalysisPipeline = Pipeline<AnalysisJob, AnalysisResult>;
+    AnalysisPipeline pipeline; // Analysis stages shared by all the sessions.
 
-            // Pipeline processing for graph analysis.
-            Pipeline pipeline;
-
-            // Step 1: Display graph, MST, and algorithm information, total MST weight.
-            pipeline.addTask([&]() -> std::string {
-                std::string result;
-                result += graph->displayGraph();
-                result += graph->displayMST();
-                result += "Algorithm: " + graph->_algorithmChoice + "\n";
-                result += "Total MST weight: " + std::to_string(graph->getTotalWeight_MST()) + "\n";
-                return result;
-            });
-            // Step 2: Average distance:
-            pipeline.addTask([&]() -> std::string {
-                return "Average distance: " + std::to_string(graph->getAverageDistance_MST()) + "\n";
-            });
-            // Step 3: Add the Heaviest path, Longest path.
-            pipeline.addTask([&]() -> std::string {
-                std::string result;
-                result += "Heaviest path: " + graph->getMaxWeightPath_MST() + "\n";
-                result += "Longest path: " + graph->getTreeDepthPath_MST() + "\n";
-               return result;
-            });
-            // Step 4: Add edge statistics (heaviest and lightest edges).
-            pipeline.addTask([&]() -> std::string {
-                return "Heaviest edge: " + graph->getMaxWeightEdge_MST() + "\n" +
-                       "Lightest edge: " + graph->getMinWeightEdge_MST() + "\n";
-            });
+    // Sections in the order they are written (binary sections follow the bit order).
+    static constexpr AnalysisMetric SECTION_ORDER[] = {
+        ANALYSIS_GRAPH, ANALYSIS_MST, ANALYSIS_WEIGHT, ANALYSIS_AVERAGE, ANALYSIS_DEPTH,
+        ANALYSIS_HEAVIEST_PATH, ANALYSIS_MAX_EDGE, ANALYSIS_MIN_EDGE};
 
-            // Execute the pipeline.
-            pipeline.start();
-            std::string analysis = pipeline.execute();
-            pipeline.stop();
+    // Returns the memoized section `metric` of the request's graph, in the request's format.
+    static const std::string& section(const AnalysisPipeline::Request& request, AnalysisMetric metric) {
+        const AnalysisJob& job = request.input;
+        return job.binary ? job.graph->getBinarySection(metric, job.token) : job.graph->getAnalysisSection(metric, job.token);
+    }
 
-            // Send the pipeline results to the client.
-            send(client_socket, analysis.c_str(), analysis.size(), 0);
-        }
+    // Returns a metric stage that computes (and memoizes in the graph) the requested sections among `metrics`.
+    // Each section has its own cache slot, so stages working on disjoint sections can run at the same time.
+    static AnalysisPipeline::Stage computeSections(unsigned metrics) {
+        return [metrics](AnalysisPipeline::Request& request) {
+            for (AnalysisMetric metric : SECTION_ORDER) {
+                if (metrics & request.output.sections & metric) section(request, metric);
+            }
+        };
+    }
 
-        // Close the client connection.
-        close(client_socket);
+    void buildPipeline() {
+        // Solve: the MST is computed once, before the metric stages read it concurrently.
+        pipeline.addStage([](AnalysisPipeline::Request& request) {
+            const AnalysisJob& job = request.input;
+            if (job.solveOnly || (job.metrics & ~ANALYSIS_GRAPH)) job.graph->Solve(job.token); // Throws if interrupted.
+            request.output.sections = job.solveOnly ? 0 : job.graph->getAvailableSections(job.metrics, job.token);
+        });
+        // Metric stages, in parallel: display graph, MST and total weight; average distance;
+        // longest and heaviest paths; heaviest and lightest edges.
+        pipeline.addParallelStage({
+            computeSections(ANALYSIS_GRAPH | ANALYSIS_MST | ANALYSIS_WEIGHT),
+            computeSections(ANALYSIS_AVERAGE),
+            computeSections(ANALYSIS_DEPTH | ANALYSIS_HEAVIEST_PATH),
+            computeSections(ANALYSIS_MAX_EDGE | ANALYSIS_MIN_EDGE),
+        });
+        // Formatter: concatenates the memoized sections, with the algorithm line in text mode.
+        pipeline.addStage([](AnalysisPipeline::Request& request) {
+            AnalysisResult& result = request.output;
+            for (AnalysisMetric metric : SECTION_ORDER) {
+                if (result.sections & metric) result.payload += section(request, metric);
+                if (metric == ANALYSIS_MST && !request.input.binary) {
+                    result.payload += "Algorithm: " + request.input.graph->_algorithmChoice + "\n";
+                }
+            }
+        });
+        pipeline.start(placement.take(pipeline.threadCount()));
     }
 };
 
-#endif // SERVER_PL_HPP
\ No newline at end of file
+#endif // SERVER_PL_HPP
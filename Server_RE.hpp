@@ -0,0 +1,395 @@
+#ifndef SERVER_RE_HPP
+#define SERVER_RE_HPP
+
+#include <algorithm>            // For std::max.
+#include <memory>               // For the connections shared with the workers.
+#include <mutex>                // For the per-connection lock.
+#include <unordered_map>        // For the connections indexed by socket.
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>          // For the event loop.
+#include <sys/eventfd.h>        // For waking the event loop on stop().
+#include "Server.hpp"           // Base server class.
+#include "WorkerPool.hpp"       // Worker threads running the commands.
+#include "Session.hpp"          // Client session state and command parsing.
+
+/**
+ * @class Server_RE
+ * @brief Implements a server using the Reactor design pattern.
+ *
+ * A single event loop waits on an edge-triggered epoll set holding the listening socket and every
+ * client socket, all non-blocking. When a client becomes readable, the loop drains the socket into
+ * the client's session and, if complete commands are waiting, hands the session to a worker thread
+ * which runs the commands and sends the replies. An idle connection therefore costs a session and
+ * a file descriptor, but no thread: the number of threads is fixed whatever the number of clients.
+ *
+ * Workers never block on a send: when a client does not read its replies and its socket fills up,
+ * the unsent replies stay in the session's output, the worker moves on, and the loop watches the
+ * socket for writability; the session goes back to the workers' queue once it can send again. No
+ * new command of that client is run while OUTPUT_DRAIN_LIMIT bytes of replies are waiting. A client
+ * that half-closes its connection still gets the replies to the commands it sent before.
+ *
+ * At most one worker serves a given session at a time, so the commands of a client are still run
+ * in order and the session itself needs no locking; only its input buffer is shared with the loop.
+ *
+ * Fair scheduling: a worker task serves one slice of a session's commands (a single heavy analysis,
+ * or a batch of light commands up to COMMAND_SLICE cost units), then queues the session again behind
+ * the other clients. The workers pick sessions by deficit round robin on the estimated cost of their
+ * next command, so a client flooding the server with large analyses does not hold up the short
+ * commands of interactive clients.
+ *
+ * Bulkhead: with a compute pool (`compute_threads` > 0), an analysis estimated above
+ * INLINE_ANALYSIS_COST is handed to the compute pool instead of being run by the worker. The worker
+ * moves on to other sessions; once the analysis is in the session's output, the session goes back
+ * to the workers' queue, which sends the replies and runs its next commands. Large MST solves then
+ * only saturate the compute pool, and the workers keep serving short commands.
+ *
+ * Background jobs (`solve async`, see SolveJobs) run on the compute pool, or on the workers without
+ * one; the session that started them keeps being served meanwhile. When a client hangs up, the MST
+ * solves still running for it (its analysis and its jobs) stop at their next checkpoint.
+ *
+ * Admission control: beyond `max_clients` connections, new clients are told the server is busy and
+ * disconnected; when the workers' queue is full, the commands just received are rejected with a
+ * "Server busy" reply instead of queueing without bound.
+ */
+class Server_RE : public Server {
+public:
+    // Events handled per epoll_wait call.
+    static constexpr int MAX_EVENTS = 256;
+    // Sessions waiting for a worker, per worker thread, before new commands are rejected.
+    static constexpr size_t MAX_PENDING_PER_WORKER = 64;
+    static constexpr size_t DEFAULT_MAX_CLIENTS = 100000;
+    // Estimated cost (see Session::nextCommandCost) of the commands run by one worker task.
+    static constexpr uint64_t COMMAND_SLICE = FairQueue<int, int>::DEFAULT_QUANTUM;
+
+    // Constructor to initialize the server with an address, port, number of worker threads and client limit.
+    // With a CPU placement, the workers take the first cores, then the event loop takes the next one,
+    // then the compute pool (if any: 0 compute threads runs the analyses on the workers).
+    Server_RE(const std::string& addr, int port, int num_threads, size_t max_clients = DEFAULT_MAX_CLIENTS,
+              CpuPlacement cpus = {}, int compute_threads = 0)
+        : Server(addr, port), placement(std::move(cpus)),
+          workers(num_threads, MAX_PENDING_PER_WORKER * num_threads, placement.take(static_cast<size_t>(num_threads))),
+          max_clients(max_clients), loop_cpu(placement.next()),
+          // No bound: a session has at most one analysis in the compute pool, and its commands were admitted.
+          compute(compute_threads, 0, placement.take(static_cast<size_t>(std::max(compute_threads, 0)))),
+          compute_threads(std::max(compute_threads, 0)) {
+        setupServerSocket(); // Sets up the server socket for communication.
+        fcntl(server_fd, F_SETFL, fcntl(server_fd, F_GETFL, 0) | O_NONBLOCK);
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd < 0 || wake_fd < 0) {
+            throw std::runtime_error("[Server_RE] Failed to create the event loop.");
+        }
+        watch(server_fd, EPOLLIN | EPOLLET);
+        watch(wake_fd, EPOLLIN);
+        log("[Server_RE] Server configured on " + address + ":" + std::to_string(port)); // Logs configuration.
+        if (placement.enabled()) LOG_INFO("[Server_RE] Threads pinned to CPUs ", formatCpuList(placement.cpus()), ".");
+        if (compute_threads > 0) LOG_INFO("[Server_RE] Compute pool: ", compute_threads, " thread(s).");
+    }
+
+    ~Server_RE() {
+        stop();
+        close(epoll_fd);
+        close(wake_fd);
+    }
+
+    // Runs the event loop until stop() is called.
+    void start() override {
+        // Ensures the server isn't started multiple times.
+        if (running.exchange(true)) {
+            log("[Server_RE] Server is already running.");
+            return;
+        }
+
+        log("[Server_RE] Server started.");
+        if (loop_cpu >= 0 && !pinCurrentThread(loop_cpu)) {
+            LOG_WARNING("[Server_RE] Failed to pin the event loop to CPU ", loop_cpu, ".");
+        }
+
+        epoll_event events[MAX_EVENTS];
+        while (running) {
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("[Server_RE] epoll_wait failed.");
+                break;
+            }
+            for (int i = 0; i < count && running; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake_fd) continue; // stop() was called.
+                if (fd == server_fd) {
+                    acceptClients();
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) resumeWriting(fd);
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) handleClient(fd);
+            }
+        }
+
+        // Each socket is closed once the worker still serving it (if any) is done; its solves stop
+        // at their next checkpoint, so stop() does not wait for them.
+        for (auto& entry : connections) {
+            entry.second->session.cancelComputations();
+            removeClient(entry.first);
+        }
+        connections.clear();
+    }
+
+    // Stops the server, wakes the event loop and waits for the commands being served.
+    void stop() override {
+        Server::stop();
+        uint64_t one = 1;
+        if (wake_fd >= 0 && write(wake_fd, &one, sizeof(one)) < 0) {
+            LOG_ERROR("[Server_RE] Failed to wake the event loop.");
+        }
+        workers.stop();
+        compute.stop();
+    }
+
+    // Called by the event loop when a client socket is readable. Edge-triggered: reads until the
+    // socket is drained, then schedules the session on a worker unless one is already serving it.
+    void handleClient(int client_socket) override {
+        auto it = connections.find(client_socket);
+        if (it == connections.end()) return;
+        std::shared_ptr<Connection> connection = it->second;
+
+        char buffer[4096];
+        bool endOfInput = false, failed = false;
+        for (;;) {
+            ssize_t bytesRead = recv(client_socket, buffer, sizeof(buffer), 0);
+            if (bytesRead > 0) {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                connection->session.feed(buffer, static_cast<size_t>(bytesRead));
+                continue;
+            }
+            if (bytesRead < 0 && errno == EINTR) continue;
+            endOfInput = bytesRead == 0;
+            failed = bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+
+        bool hangup;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            if (endOfInput) connection->input_closed = true;
+            if (!connection->scheduled && !connection->closing && connection->session.hasCommand()) {
+                connection->scheduled = workers.try_submit(client_socket, connection->session.nextCommandCost(),
+                                                           [this, connection]() { serve(connection); });
+                if (!connection->scheduled) {
+                    // No worker touches an unscheduled session, so the loop can answer it.
+                    size_t rejected = connection->session.rejectPending("Server busy");
+                    LOG_WARNING("[Server_RE] Workers saturated, ", rejected, " command(s) rejected.");
+                    if (connection->session.flush() && !connection->session.output.empty()) {
+                        connection->scheduled = true;
+                        waitWritable(*connection);
+                    }
+                }
+            }
+            // After a half-close, the worker still serving the connection replies to the commands
+            // already received, then shuts the socket down, and the loop drops it on the next event.
+            hangup = failed || (connection->input_closed && !connection->scheduled);
+        }
+
+        if (hangup) {
+            // Nobody will read the analysis or the jobs still running for this client.
+            connection->session.cancelComputations();
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_socket, nullptr);
+            connections.erase(it);
+            workers.forget(client_socket);
+            removeClient(client_socket);
+        }
+    }
+
+protected:
+    CpuPlacement placement; // Cores handed out to the server's threads (workers, loop, then subclasses').
+
+    // Writes the analysis requested by the session into its output (runs on a worker thread).
+    virtual void analyze(Session& session) {
+        session.writeAnalysis();
+    }
+
+    // Starts the analysis requested by the session off the workers; `done` must be called, from any
+    // thread, once the analysis is in the session's output. Returns false if there is nowhere to
+    // offload it (the worker then runs `analyze` itself).
+    virtual bool analyzeAsync(Session& session, UniqueTask done) {
+        if (compute_threads == 0) return false;
+        // The compute thread only appends to the session's output: the worker resumed by `done` sends it.
+        return compute.submit(session.socket(), session.analysisCost(), [this, &session, done = std::move(done)]() mutable {
+            session.holdOutput(true);
+            analyze(session);
+            session.holdOutput(false);
+            done();
+        });
+    }
+
+private:
+    // A client as seen by the event loop (reads) and by the worker running its commands.
+    struct Connection {
+        Session session;           // Graph, settings and buffers of the client.
+        std::mutex mutex;          // Protects the session's input buffer and the flags below.
+        bool scheduled = false;    // A worker task is queued or running for this connection, or it waits to send.
+        bool writing = false;      // The socket is full: the loop resumes the connection once it is writable.
+        bool closing = false;      // The client asked to close: further input is ignored.
+        bool input_closed = false; // The client half-closed the connection: no more input will come.
+        bool shut_down = false;    // The socket was shut down once the replies were sent.
+
+        explicit Connection(int socket) : session(socket) {}
+        ~Connection() { close(session.socket()); }
+    };
+
+    WorkerPool workers;       // Worker threads running the commands.
+    size_t max_clients;       // Connections accepted before new clients are turned away.
+    int loop_cpu;             // Core of the event loop thread (-1: not pinned).
+    WorkerPool compute;       // Threads running the large analyses (bulkhead), if compute_threads > 0.
+    int compute_threads;      // Size of the compute pool (0: analyses run on the workers).
+    int epoll_fd = -1;        // Readiness of the listening socket, the clients and wake_fd.
+    int wake_fd = -1;         // Written by stop() to interrupt epoll_wait.
+    // Connected clients, only accessed by the event loop thread.
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+
+    // Events watched on a client socket while its replies can be sent.
+    static constexpr uint32_t CLIENT_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET;
+
+    void watch(int fd, uint32_t events, int op = EPOLL_CTL_ADD) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, op, fd, &event) < 0 && op == EPOLL_CTL_ADD) {
+            LOG_ERROR("[Server_RE] Failed to watch socket ", fd, ".");
+        }
+    }
+
+    // Parks a scheduled connection whose socket is full until the loop sees it writable (called with
+    // the connection locked). Modifying the watched events reports the current readiness again, so a
+    // socket drained in the meantime is not missed.
+    void waitWritable(Connection& connection) {
+        connection.writing = true;
+        watch(connection.session.socket(), CLIENT_EVENTS | EPOLLOUT, EPOLL_CTL_MOD);
+    }
+
+    // Called by the event loop when a parked client socket is writable: a worker sends the rest of
+    // the replies and runs the next commands.
+    void resumeWriting(int client_socket) {
+        auto it = connections.find(client_socket);
+        if (it == connections.end()) return;
+        std::shared_ptr<Connection> connection = it->second;
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        if (!connection->writing) return;
+        connection->writing = false;
+        watch(client_socket, CLIENT_EVENTS, EPOLL_CTL_MOD);
+        if (!workers.submit(client_socket, 1, [this, connection]() { serve(connection); })) {
+            connection->scheduled = false; // Server stopping.
+        }
+    }
+
+    // Edge-triggered: accepts until the backlog is empty, otherwise no new event would come.
+    void acceptClients() {
+        while (running) {
+            int client_socket = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (client_socket < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running) {
+                    LOG_ERROR("[Server_RE] Failed to accept connection.");
+                }
+                return;
+            }
+            if (connections.size() >= max_clients) {
+                static const char busy[] = "Server busy: too many clients, try again later.\n";
+                if (send(client_socket, busy, sizeof(busy) - 1, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+                    LOG_WARNING("[Server_RE] Failed to notify a rejected client.");
+                }
+                close(client_socket);
+                continue;
+            }
+            // If the client is not added successfully, close the connection.
+            if (!addClient(client_socket)) {
+                close(client_socket);
+                continue;
+            }
+
+            auto connection = std::make_shared<Connection>(client_socket);
+            // `solve async` jobs run on the compute pool if any, otherwise on the workers, queued
+            // fairly with the commands of the other clients.
+            connection->session.setJobExecutor([this, client_socket](UniqueTask job, uint64_t cost) {
+                return (compute_threads > 0 ? compute : workers).submit(client_socket, cost, std::move(job));
+            });
+            connections.emplace(client_socket, connection);
+            watch(client_socket, CLIENT_EVENTS);
+            connection->session.output << Session::helpMenu();
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            if (connection->session.flush() && !connection->session.output.empty()) {
+                connection->scheduled = true;
+                waitWritable(*connection);
+            }
+            connection->session.output.releaseSpares();
+        }
+    }
+
+    // Runs one slice of the session's commands (always at least one), then sends the replies in one
+    // go. If commands remain, the session goes back to the workers' queue behind the other clients.
+    // If the socket fills up, the session waits for the loop to see it writable (see waitWritable).
+    void serve(const std::shared_ptr<Connection>& connection) {
+        Session& session = connection->session;
+        std::string command;
+        uint64_t spent = 0; // Estimated cost of the commands run by this task
+
+        std::unique_lock<std::mutex> lock(connection->mutex);
+        bool& closing = connection->closing; // Set under the lock: the loop reads it.
+        for (;;) {
+            uint64_t cost = session.hasCommand() ? session.nextCommandCost() : 0;
+            // Replies the client has not read yet hold back its next commands.
+            bool backlogged = session.output.size() >= Session::OUTPUT_DRAIN_LIMIT;
+            if (!closing && !backlogged && cost > 0 && (spent == 0 || spent + cost <= COMMAND_SLICE) &&
+                session.nextCommand(command)) {
+                spent += cost;
+                lock.unlock();
+                Session::Action action = session.execute(command);
+                if (action == Session::Action::Analyze) {
+                    if (session.analysisCost() > INLINE_ANALYSIS_COST &&
+                        analyzeAsync(session, [this, connection]() { resume(connection); })) {
+                        return; // Still scheduled: `resume` queues the session again.
+                    }
+                    analyze(session);
+                }
+                lock.lock();
+                closing = action == Session::Action::Close;
+                continue;
+            }
+            // Commands that arrived during the send are run by this same task.
+            if (session.output.empty()) break;
+            lock.unlock();
+            bool sent = session.flush();
+            lock.lock();
+            if (!sent) {
+                closing = true;
+            } else if (!session.output.empty()) {
+                waitWritable(*connection);
+                return; // Still scheduled: `resumeWriting` queues the session again.
+            }
+        }
+        // An idle connection keeps no output chunk: with many clients, most of them are idle.
+        session.output.releaseSpares();
+        if (!closing && session.hasCommand() &&
+            workers.submit(session.socket(), session.nextCommandCost(), [this, connection]() { serve(connection); })) {
+            return; // Still scheduled: the next slice is queued.
+        }
+        connection->scheduled = false;
+        if ((closing || connection->input_closed) && !connection->shut_down) {
+            // The event loop sees the hangup and drops the connection.
+            connection->shut_down = true;
+            shutdown(session.socket(), SHUT_RDWR);
+        }
+    }
+
+    // Called once an offloaded analysis is in the session's output: a worker sends it and goes on.
+    void resume(const std::shared_ptr<Connection>& connection) {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        if (!workers.submit(connection->session.socket(), connection->session.nextCommandCost(),
+                            [this, connection]() { serve(connection); })) {
+            connection->scheduled = false; // Server stopping.
+        }
+    }
+};
+
+#endif // SERVER_RE_HPP
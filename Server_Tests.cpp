@@ -0,0 +1,273 @@
+/*
+ * End-to-end tests of the servers: each test starts a server on a loopback port in this process,
+ * connects plain blocking clients to it and checks the replies they read.
+ */
+#include "../../src/Model_Test/doctest.h"
+#include "../../src/Network/Server_LF.hpp"
+#include "../../src/Network/Server_RE.hpp"
+#include "../../src/Network/Session.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int BASE_PORT = 9700;
+constexpr int PORT_ATTEMPTS = 200;
+constexpr int REPLY_TIMEOUT_MS = 10000;
+
+// Runs a server on its own thread, on the first free port from BASE_PORT, and stops it on destruction.
+// Only errors are logged meanwhile.
+template <typename S>
+class TestServer {
+public:
+    template <typename... Args>
+    explicit TestServer(Args... args) {
+        setLogLevel(LogLevel::Error);
+        for (int attempt = 0; attempt < PORT_ATTEMPTS && !server; ++attempt) {
+            try {
+                server = std::make_unique<S>("127.0.0.1", BASE_PORT + attempt, args...);
+                port = BASE_PORT + attempt;
+            } catch (const std::runtime_error&) {
+                // Port taken: try the next one.
+            }
+        }
+        if (!server) throw std::runtime_error("No free port for the test server.");
+        loop = std::thread([this]() { server->start(); });
+    }
+
+    ~TestServer() {
+        server->stop();
+        loop.join();
+        server.reset();
+        flushLogs();
+        setLogLevel(LogLevel::Info);
+    }
+
+    S& operator*() { return *server; }
+    int port = 0;
+
+private:
+    std::unique_ptr<S> server;
+    std::thread loop;
+};
+
+int connectTo(int port, int receiveBuffer = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    // Before connect: the window advertised to the server follows the receive buffer.
+    if (receiveBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(port);
+    REQUIRE(connect(fd, (struct sockaddr*)&server, sizeof(server)) == 0);
+    return fd;
+}
+
+void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+// Reads until `received` contains `marker` (empty: until the server closes the connection).
+// Returns false on timeout, or if the connection closes first.
+bool readUntil(int fd, std::string& received, const std::string& marker, int timeoutMs = REPLY_TIMEOUT_MS) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char buffer[4096];
+    while (marker.empty() || received.find(marker) == std::string::npos) {
+        int left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        pollfd ready{fd, POLLIN, 0};
+        if (left <= 0 || poll(&ready, 1, left) <= 0) return false;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return marker.empty() && n == 0;
+        received.append(buffer, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+// Connects and reads the help menu the server sends first.
+int connectClient(int port, int receiveBuffer = 0) {
+    int fd = connectTo(port, receiveBuffer);
+    std::string menu;
+    CHECK(readUntil(fd, menu, Session::helpMenu()));
+    return fd;
+}
+
+} // namespace
+
+TEST_CASE("Server_RE: Concurrent Clients Get Their Replies In Order") {
+    TestServer<Server_RE> server(2);
+    const int clients = 8;
+    std::vector<int> sockets;
+    for (int i = 0; i < clients; ++i) sockets.push_back(connectClient(server.port));
+
+    // Every client sends its whole script at once; the replies must come back in the same order.
+    for (int i = 0; i < clients; ++i) {
+        std::string script = "autoanalyze 0\ncreate " + std::to_string(i + 2) + "\n";
+        for (int v = 1; v < i + 2; ++v) script += "add 0 " + std::to_string(v) + " " + std::to_string(v) + "\n";
+        sendAll(sockets[i], script + "analyze weight\n");
+    }
+    for (int i = 0; i < clients; ++i) {
+        int weight = (i + 1) * (i + 2) / 2;
+        std::string replies;
+        CHECK(readUntil(sockets[i], replies, "Total MST weight: " + std::to_string(weight)));
+        size_t created = replies.find("Graph created with " + std::to_string(i + 2) + " vertices.");
+        size_t lastEdge = replies.find("Edge added: (0, " + std::to_string(i + 1) + ")");
+        CHECK(created < lastEdge);
+        CHECK(lastEdge < replies.find("Total MST weight"));
+        close(sockets[i]);
+    }
+}
+
+TEST_CASE("Server_RE: A Client That Does Not Read Does Not Hold Up The Others") {
+    TestServer<Server_RE> server(1);
+    int hog = connectClient(server.port, 4096);
+    int other = connectClient(server.port);
+
+    // Far more replies than the socket buffers hold: the worker parks them instead of blocking.
+    std::string script = "autoanalyze 0\ncreate 200\n";
+    for (int v = 1; v < 200; ++v) script += "add " + std::to_string(v - 1) + " " + std::to_string(v) + " 1\n";
+    for (int i = 0; i < 50; ++i) script += "show graph\n";
+    std::thread sender([hog, &script]() { sendAll(hog, script); });
+
+    for (int i = 0; i < 5; ++i) {
+        sendAll(other, "autoanalyze 0\n");
+        std::string reply;
+        CHECK(readUntil(other, reply, "Automatic analysis disabled."));
+    }
+    shutdown(hog, SHUT_RDWR); // Unblocks the sender if the server stopped reading.
+    sender.join();
+    close(hog);
+    close(other);
+}
+
+TEST_CASE("Server_RE: A Half-Closed Client Gets Its Replies Before The Server Hangs Up") {
+    TestServer<Server_RE> server(2);
+    int fd = connectClient(server.port);
+    sendAll(fd, "autoanalyze 0\ncreate 3\nadd 0 1 4\nadd 1 2 5\nanalyze weight\n");
+    shutdown(fd, SHUT_WR);
+    std::string replies;
+    CHECK(readUntil(fd, replies, "")); // Until the server closes its side.
+    CHECK(replies.find("Total MST weight: 9") != std::string::npos);
+    close(fd);
+}
+
+TEST_CASE("Server_LF: Clients That Do Not Read Hold No Thread") {
+    TestServer<Server_LF> server(2, CpuPlacement{}, 0, 0);
+
+    // Two clients flood the two pool threads with replies and never read them.
+    std::string script = "autoanalyze 0\ncreate 20001\n";
+    for (int v = 0; v < 20000; ++v) script += "add " + std::to_string(v) + " " + std::to_string(v + 1) + " 1\n";
+    for (int i = 0; i < 20; ++i) script += "show graph\n";
+    std::vector<int> hogs;
+    std::vector<std::thread> senders;
+    for (int i = 0; i < 2; ++i) {
+        hogs.push_back(connectTo(server.port, 4096));
+        senders.emplace_back([fd = hogs.back(), &script]() { sendAll(fd, script); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // A new client is still accepted and served.
+    int fd = connectTo(server.port);
+    std::string replies;
+    CHECK(readUntil(fd, replies, Session::helpMenu(), 3000));
+    sendAll(fd, "autoanalyze 0\n");
+    CHECK(readUntil(fd, replies, "Automatic analysis disabled.", 3000));
+    close(fd);
+
+    for (int hog : hogs) shutdown(hog, SHUT_RDWR); // Unblocks the senders.
+    for (std::thread& sender : senders) sender.join();
+    for (int hog : hogs) close(hog);
+}
+
+TEST_CASE("Server_LF: Large Analyses Without A Compute Pool Are Split Over The Pool") {
+    TestServer<Server_LF> server(2);
+    int fd = connectClient(server.port);
+    // Above INLINE_ANALYSIS_COST: the sections are computed by parallel_for on the pool threads.
+    const int V = 3000;
+    double weight = 0;
+    std::string script = "autoanalyze 0\ncreate " + std::to_string(V) + "\n";
+    for (int v = 1; v < V; ++v) {
+        script += "add " + std::to_string(v - 1) + " " + std::to_string(v) + " " + std::to_string(v % 7 + 1) + "\n";
+        weight += v % 7 + 1;
+    }
+    sendAll(fd, script + "analyze weight maxedge minedge depth\nanalyze weight\n");
+
+    const std::string total = "Total MST weight: " + std::to_string(weight) + "\n";
+    std::string replies;
+    REQUIRE(readUntil(fd, replies, "Lightest edge: "));
+    CHECK(replies.find(total) != std::string::npos);
+    CHECK(replies.find("Heaviest edge: ") != std::string::npos);
+    CHECK(replies.find("Longest path: ") != std::string::npos);
+    // The second analysis, written from the memoized section, ends right after the weight.
+    CHECK(readUntil(fd, replies, total + std::string(15, ' ') + "---"));
+    close(fd);
+}
+
+TEST_CASE("Server_LF: Stop Wakes The Leader And Closes Every Socket") {
+    TestServer<Server_LF> server(2);
+    int fd = connectClient(server.port);
+    (*server).stop(); // The leader is waiting in epoll_wait on the listening socket.
+
+    std::string rest;
+    CHECK(readUntil(fd, rest, "")); // The client's connection is closed.
+    close(fd);
+
+    // The listening socket is closed too: new connections are refused.
+    int late = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(late >= 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(server.port);
+    CHECK(connect(late, (struct sockaddr*)&address, sizeof(address)) != 0);
+    close(late);
+}
+
+TEST_CASE("Server_LF: Large Analyses Leave The Pool To Other Clients") {
+    // One pool thread: if it ran the analysis itself, the other client would wait for it.
+    TestServer<Server_LF> server(1, CpuPlacement{}, 1, 1);
+    int fd = connectClient(server.port);
+    int other = connectClient(server.port);
+
+    // Above INLINE_ANALYSIS_COST while the MST is stale (1 + V + E), but small enough for the
+    // average distance (Floyd-Warshall over the MST) to take a while.
+    const int V = 500;
+    std::string script = "autoanalyze 0\ncreate " + std::to_string(V) + "\n";
+    for (int v = 0; v < V; ++v) {
+        for (int step = 1; step <= 10 && v + step < V; ++step) {
+            script += "add " + std::to_string(v) + " " + std::to_string(v + step) + " " + std::to_string(step) + "\n";
+        }
+    }
+    std::string replies;
+    sendAll(fd, script + "show mst 0 2\n");
+    REQUIRE(readUntil(fd, replies, "Edges from index 0 (2 of " + std::to_string(V - 1) + " shown):\n"));
+    CHECK(readUntil(fd, replies, "Vertex 1 <----(1)----> Vertex 2\n"));
+
+    // The page solved the MST: removing one of its edges makes it stale again, and the analysis goes
+    // to the compute pool while the pool thread serves the other client.
+    sendAll(fd, "remove 0 1\n");
+    CHECK(readUntil(fd, replies, "Edge removed: (0, 1)"));
+    replies.clear();
+    sendAll(fd, "analyze average\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // The analysis has started.
+    std::string otherReplies;
+    sendAll(other, "autoanalyze 0\n");
+    CHECK(readUntil(other, otherReplies, "Automatic analysis disabled."));
+    pollfd analysis{fd, POLLIN, 0};
+    CHECK(poll(&analysis, 1, 0) == 0); // Still being computed.
+    CHECK(readUntil(fd, replies, "Average distance: "));
+    close(other);
+    close(fd);
+}
@@ -0,0 +1,503 @@
+#include "Session.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+
+Session::Session(int socket, int autoAnalyzeInterval)
+    : _socket(socket), _autoAnalyzeInterval(autoAnalyzeInterval), _solve(_lifetime), _jobs(_lifetime) {
+    // Les grosses réponses partent par morceaux au lieu d'être construites en entier ; si le client ne
+    // lit plus, elles restent dans `output` jusqu'au prochain `flush` du serveur.
+    output.setDrain(OUTPUT_DRAIN_LIMIT, [this](OutputBuffer&) {
+        if (!_outputHeld && !_sendBlocked) flush();
+    });
+}
+
+Session::~Session() {
+    cancelComputations(); // Les travaux encore en file ou en cours n'ont plus de lecteur.
+}
+
+const std::string& Session::helpMenu() {
+    static const std::string menu =
+        "------------------------ COMMAND MENU --------------------------------------------\n"
+        "Create a new graph:\n   - Syntax: 'create <number_of_vertices>'\n"
+        "Add an edge:\n   - Syntax: 'add <u> <v> <w>'\n"
+        "Remove an edge:\n   - Syntax: 'remove <u> <v>'\n"
+        "Choose MST Algorithm:\n   - Syntax: 'algo <algorithm_name>'\n     (prim/kruskal/tarjan/boruvka/integer_mst)\n"
+        "Analyze the graph:\n   - Syntax: 'analyze [metrics...]'\n     (all/graph/mst/weight/average/depth/heaviest/maxedge/minedge)\n"
+        "Solve in the background:\n   - Syntax: 'solve async [metrics...]'\n     (analyzes a copy of the graph, returns a job id; unfinished jobs are cancelled)\n"
+        "Follow a background job:\n   - Syntax: 'status <job_id>', 'result <job_id>', 'cancel <job_id>'\n"
+        "Show the graph or the MST:\n   - Syntax: 'show <graph|mst> [offset] [count]'\n     (only 'count' edges starting at 'offset')\n"
+        "Automatic analysis:\n   - Syntax: 'autoanalyze <n>'\n     (analyze every n changes, 0 = only on 'analyze')\n"
+        "Solve deadline:\n   - Syntax: 'deadline <ms>'\n     (stop MST solves taking longer than ms milliseconds, 0 = no deadline)\n"
+        "Response format:\n   - Syntax: 'format <text|binary>'\n     (binary: length-prefixed frames, see OutputBuffer.hpp)\n"
+        "Shutdown:\n   - Syntax: 'shutdown'\n"
+        "----------------------------------------------------------------------------------\n";
+    return menu;
+}
+
+namespace {
+// Commande rendue par `nextCommand` après une commande trop longue : aucune ligne reçue ne contient '\n'.
+const std::string INPUT_OVERFLOW = "\n";
+} // namespace
+
+bool Session::feed(const char* data, size_t size) {
+    if (_inputOverflow) return false;
+    _input.append(data, size);
+    // Seule la dernière commande, incomplète, peut dépasser la limite : les précédentes l'ont déjà passée.
+    size_t last = _input.rfind('\n');
+    size_t partial = last == std::string::npos ? _input.size() : _input.size() - last - 1;
+    if (partial <= MAX_LINE_LENGTH) return true;
+    _input.resize(_input.size() - partial);
+    _inputOverflow = true;
+    return false;
+}
+
+// Découpe le tampon d'entrée sur '\n' (un '\r' final est ignoré).
+bool Session::nextCommand(std::string& command) {
+    size_t end = _input.find('\n');
+    if (end == std::string::npos) {
+        if (!_inputOverflow) return false;
+        _inputOverflow = false; // La session se ferme sur cette commande.
+        command = INPUT_OVERFLOW;
+        return true;
+    }
+    command.assign(_input, 0, end);
+    if (!command.empty() && command.back() == '\r') command.pop_back();
+    _input.erase(0, end + 1);
+    return true;
+}
+
+uint64_t Session::nextCommandCost() const {
+    size_t end = _input.find('\n');
+    if (end == std::string::npos || !graph) return 1;
+    size_t begin = _input.find_first_not_of(" \t", 0);
+    if (begin >= end) return 1;
+    size_t wordEnd = std::min(_input.find_first_of(" \t\r\n", begin), end);
+    std::string command = _input.substr(begin, wordEnd - begin);
+
+    if (command == "show") {
+        // Une page de l'ACM périmé le recalcule d'abord, comme une analyse.
+        size_t what = _input.find_first_not_of(" \t", wordEnd);
+        bool solves = what < end && _input.compare(what, 3, "mst") == 0 && !graph->isMSTUpToDate();
+        return 1 + graph->getNumEdges() + (solves ? analysisCost() : 0);
+    }
+    if (command == "solve") return 1 + graph->getNumEdges(); // Copie du graphe ; le calcul se fait ailleurs.
+    bool mutation = command == "create" || command == "add" || command == "remove" || command == "algo";
+    bool analyzes = command == "analyze" ||
+                    (mutation && _autoAnalyzeInterval > 0 && _mutationsSinceAnalysis + 1 >= _autoAnalyzeInterval);
+    if (!analyzes) return 1;
+    // Une mutation invalide l'ACM : l'analyse qu'elle déclenche le recalcule.
+    return mutation && graph->isMSTUpToDate() ? analysisCost() + graph->getNumEdges() : analysisCost();
+}
+
+uint64_t Session::analysisCost() const {
+    if (!graph) return 1;
+    uint64_t vertices = static_cast<uint64_t>(std::max(graph->getNumVertices(), 0));
+    return 1 + vertices + (graph->isMSTUpToDate() ? 0 : graph->getNumEdges());
+}
+
+Session::Action Session::mutated() {
+    ++_mutationsSinceAnalysis;
+    if (_autoAnalyzeInterval > 0 && _mutationsSinceAnalysis >= _autoAnalyzeInterval) {
+        _mutationsSinceAnalysis = 0;
+        return Action::Analyze;
+    }
+    return Action::None;
+}
+
+// En mode binaire, la réponse texte est d'abord écrite dans `_reply` pour connaître la taille de sa trame.
+Session::Action Session::execute(const std::string& request) {
+    _pendingPage.reset(); // Une page que l'analyse en échec n'a pas écrite est abandonnée.
+    Action action = dispatch(request, binary ? _reply : output);
+    frameReply();
+    return action;
+}
+
+size_t Session::rejectPending(const std::string& reason) {
+    size_t end = _input.rfind('\n');
+    if (end == std::string::npos) return 0;
+    size_t count = static_cast<size_t>(std::count(_input.begin(), _input.begin() + end + 1, '\n'));
+    _input.erase(0, end + 1);
+
+    OutputBuffer& out = binary ? _reply : output;
+    out << "Error: " << reason << ", " << count << " command(s) dropped. Try again.\n";
+    frameReply();
+    return count;
+}
+
+void Session::reply(const std::string& text) {
+    (binary ? _reply : output) << text;
+    frameReply();
+}
+
+void Session::frameReply() {
+    if (_reply.empty()) return;
+    output.writeFrameHeader(FRAME_TEXT, static_cast<uint32_t>(_reply.size())).append(_reply);
+    _reply.clear();
+}
+
+Session::Progress Session::resume(int budget, uint64_t inlineAnalysisCost) {
+    std::string command;
+    while (!_closed && budget-- > 0 && nextCommand(command)) {
+        Action action = execute(command);
+        if (action == Action::Analyze) {
+            if (analysisCost() > inlineAnalysisCost) return Progress::Analyze;
+            writeAnalysis();
+        }
+        _closed = action == Action::Close;
+    }
+    if (_closed) return Progress::Closed;
+    return hasCommand() ? Progress::Pending : Progress::Idle;
+}
+
+CancellationToken* Session::beginSolve() {
+    if (_solveTimeout > std::chrono::milliseconds::zero()) {
+        _solve.setDeadline(CancellationToken::Clock::now() + _solveTimeout);
+    } else {
+        _solve.clearDeadline();
+    }
+    return &_solve;
+}
+
+void Session::replyCancelled(const OperationCancelled& reason) {
+    if (dynamic_cast<const DeadlineExceeded*>(&reason)) {
+        reply("Error: MST solve stopped after the " + std::to_string(_solveTimeout.count()) +
+              " ms deadline. Use 'deadline' to change it.\n");
+    } else {
+        reply("Error: Analysis cancelled.\n");
+    }
+}
+
+void Session::writeAnalysis() {
+    if (_pendingPage) {
+        Page page = *_pendingPage;
+        _pendingPage.reset();
+        // L'ACM est calculé avant d'écrire quoi que ce soit : une page interrompue n'écrit que l'erreur.
+        try {
+            if (binary) graph->writeEdgesBinary(output, true, page.offset, page.count, beginSolve());
+            else graph->writeMST(output, page.offset, page.count, beginSolve());
+        } catch (const OperationCancelled& reason) {
+            replyCancelled(reason);
+        }
+        return;
+    }
+    // L'ACM est calculé d'abord, sous le jeton de la session ; les sections le trouvent à jour.
+    if (metrics & ~ANALYSIS_GRAPH) {
+        try {
+            graph->Solve(beginSolve());
+        } catch (const OperationCancelled& reason) {
+            replyCancelled(reason);
+            return;
+        }
+    }
+    if (binary) graph->writeAnalysisBinary(output, metrics, &_solve);
+    else graph->writeAnalysis(output, metrics, &_solve);
+}
+
+void Session::writeAnalysisFrame(unsigned sections, const std::string& payload) {
+    output.writeFrameHeader(FRAME_ANALYSIS, static_cast<uint32_t>(4 + payload.size())).writeU32(sections);
+    output << payload;
+}
+
+namespace {
+
+// Lit les sections d'analyse en fin de commande ; sans argument, l'analyse est complète.
+// false (erreur écrite dans `out`) si une section est inconnue.
+bool readMetrics(std::stringstream& ss, OutputBuffer& out, unsigned& requested) {
+    requested = 0;
+    std::string name;
+    while (ss >> name) {
+        unsigned metric = parseAnalysisMetric(name);
+        if (!metric) {
+            out << "Error: Unknown metric '" << name << "'.\n";
+            return false;
+        }
+        requested |= metric;
+    }
+    if (!requested) requested = ANALYSIS_ALL;
+    return true;
+}
+
+} // namespace
+
+Session::Action Session::dispatch(const std::string& request, OutputBuffer& out) {
+    if (request == INPUT_OVERFLOW) {
+        cancelComputations();
+        out << "Error: Command longer than " << MAX_LINE_LENGTH << " bytes. Closing the session.\n";
+        return Action::Close;
+    }
+    std::stringstream ss(request); // Crée un flux à partir de la commande.
+    std::string command;
+    ss >> command; // Extrait la commande principale.
+
+    if (command.empty()) {
+        return Action::None; // Ligne vide : rien à faire.
+    }
+    if (command == "create") {
+        std::string token;
+        if (ss >> token) { // Vérifier si un argument est fourni après "create".
+            try {
+                int size = std::stoi(token); // Convertir l'argument en entier.
+                if (size < 0) {
+                    out << "Error: Number of vertices must be greater than or equal to 0.\n";
+                } else {
+                    graph = std::make_unique<Graph>(size); // Créer ou réinitialiser le graphe.
+                    out << "Graph created with " << size << " vertices.\n";
+                    return mutated();
+                }
+            } catch (const std::invalid_argument&) {
+                // Si l'argument n'est pas un entier valide.
+                out << "Invalid input. Syntax: 'create <number_of_vertices>'\n";
+            } catch (const std::out_of_range&) {
+                // Si l'entier est trop grand ou trop petit.
+                out << "Error: Number out of range.\n";
+            }
+        } else {
+            // Aucun argument fourni : ne fait rien et indique l'erreur.
+            out << "Error: Number of vertices not provided. Syntax: 'create <number_of_vertices>'\n";
+        }
+        return Action::None;
+    }
+    if (command == "add") {
+        if (!graph) {
+            out << "Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        int u, v, weight;
+        if (ss >> u >> v >> weight) {
+            if (u == v) {
+                out << "Error: Self-loops are not allowed.\n";
+                return Action::None;
+            }
+            graph->add_edge(u, v, weight);
+            out << "Edge added: (" << u << ", " << v << ") with weight " << weight << "\n";
+            return mutated();
+        }
+        out << "Invalid input. Syntax: 'add <u> <v> <w>'\n";
+        return Action::None;
+    }
+    if (command == "remove") {
+        if (!graph) {
+            out << "Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        int u, v;
+        if (ss >> u >> v) {
+            graph->remove_edge(u, v);
+            out << "Edge removed: (" << u << ", " << v << ")\n";
+            return mutated();
+        }
+        out << "Invalid input. Syntax: 'remove <u> <v>'\n";
+        return Action::None;
+    }
+    if (command == "algo") {
+        if (!graph) {
+            LOG_DEBUG("[Session] Graph not initialized when trying to set algorithm.");
+            out << "Error: Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        std::string selectedAlgorithm;
+        if (ss >> selectedAlgorithm) {
+            if (selectedAlgorithm == "prim" || selectedAlgorithm == "kruskal" ||
+                selectedAlgorithm == "boruvka" || selectedAlgorithm == "tarjan" ||
+                selectedAlgorithm == "integer_mst") {
+                graph->_algorithmChoice = selectedAlgorithm;
+                LOG_DEBUG("[Session] Algorithm set to ", selectedAlgorithm, ".");
+                out << "Algorithm set to " << selectedAlgorithm << ".\n";
+                return mutated();
+            }
+            LOG_DEBUG("[Session] Unknown algorithm: ", selectedAlgorithm);
+            out << "Error: Unknown algorithm '" << selectedAlgorithm << "'.\n";
+        } else {
+            out << "Invalid input. Syntax: 'algo <algorithm_name>'\n";
+        }
+        return Action::None;
+    }
+    if (command == "analyze") {
+        if (!graph) {
+            out << "Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        unsigned requested;
+        if (!readMetrics(ss, out, requested)) return Action::None;
+        metrics = requested;
+        _mutationsSinceAnalysis = 0;
+        return Action::Analyze;
+    }
+    if (command == "solve") {
+        if (!graph) {
+            out << "Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        std::string mode;
+        if (!(ss >> mode) || mode != "async") {
+            out << "Invalid input. Syntax: 'solve async [metrics...]'\n";
+            return Action::None;
+        }
+        unsigned requested;
+        if (!readMetrics(ss, out, requested)) return Action::None;
+        // Les travaux pas encore terminés portent sur un graphe dépassé : personne ne lira leur résultat.
+        size_t superseded = _jobs.cancelUnfinished();
+        // L'analyse se fait sur une copie : les mutations suivantes ne la concernent pas.
+        uint64_t id = _jobs.start(*graph, requested, binary, _solveTimeout);
+        if (id == 0) {
+            out << "Error: Cannot start a job (at most " << SolveJobs::MAX_JOBS
+                << " finished jobs not fetched). Use 'result <job_id>' first.\n";
+        } else {
+            out << "Job " << id << " started. Use 'status " << id << "' and 'result " << id << "'.\n";
+        }
+        if (superseded > 0) out << superseded << " unfinished job(s) cancelled.\n";
+        return Action::None;
+    }
+    if (command == "status" || command == "result" || command == "cancel") {
+        uint64_t id;
+        SolveJobs::Status status;
+        if (!(ss >> id)) {
+            out << "Invalid input. Syntax: '" << command << " <job_id>'\n";
+            return Action::None;
+        }
+        if (!_jobs.status(id, status)) {
+            out << "Error: Unknown job " << id << ".\n";
+            return Action::None;
+        }
+        if (command == "cancel") {
+            if (status.state == SolveJobs::State::Done || status.state == SolveJobs::State::Failed) {
+                out << "Job " << id << " already finished.\n";
+            } else {
+                _jobs.cancel(id);
+                out << "Job " << id << " cancelled.\n";
+            }
+            return Action::None;
+        }
+        if (command == "result" && status.state == SolveJobs::State::Done) {
+            if (status.binary != binary) {
+                out << "Error: Job " << id << " was analyzed in " << (status.binary ? "binary" : "text")
+                    << " format. Use 'format " << (status.binary ? "binary" : "text") << "' first.\n";
+            } else {
+                _jobs.takeResult(id, output); // Comme `show`, le résultat va directement dans `output`.
+            }
+            return Action::None;
+        }
+        out << "Job " << id << ": ";
+        switch (status.state) {
+        case SolveJobs::State::Queued: out << "queued"; break;
+        case SolveJobs::State::Solving: out << "solving (" << static_cast<int>(status.progress * 100) << "%)"; break;
+        case SolveJobs::State::Analyzing: out << "analyzing"; break;
+        case SolveJobs::State::Done: out << "done"; break;
+        case SolveJobs::State::Cancelled: out << "cancelled"; break;
+        case SolveJobs::State::Failed: out << "failed (" << status.error << ")"; break;
+        }
+        out << ".\n";
+        // Un travail annulé ou en échec n'a pas de résultat : `result` le rapporte puis l'oublie.
+        if (command == "result" &&
+            (status.state == SolveJobs::State::Cancelled || status.state == SolveJobs::State::Failed)) {
+            _jobs.forget(id);
+        }
+        return Action::None;
+    }
+    if (command == "show") {
+        if (!graph) {
+            out << "Graph not created. Use 'create' first.\n";
+            return Action::None;
+        }
+        // Page d'arêtes optionnelle : rien n'est matérialisé au-delà de `count` arêtes.
+        std::string what;
+        long long offset = 0, count = -1, value;
+        ss >> what;
+        if (ss >> value) {
+            offset = value;
+            if (ss >> value) count = value;
+        }
+        if ((what != "graph" && what != "mst") || offset < 0 || (!ss.eof() && ss.fail())) {
+            out << "Invalid input. Syntax: 'show <graph|mst> [offset] [count]'\n";
+            return Action::None;
+        }
+        size_t pageCount = count < 0 ? static_cast<size_t>(-1) : static_cast<size_t>(count);
+        if (what == "mst" && !graph->isMSTUpToDate()) {
+            // L'ACM doit être recalculé : la page est écrite par `writeAnalysis`, comme une analyse,
+            // pour que le serveur puisse déporter ce calcul.
+            _pendingPage = Page{static_cast<size_t>(offset), pageCount};
+            return Action::Analyze;
+        }
+        try {
+            if (binary) graph->writeEdgesBinary(output, what == "mst", static_cast<size_t>(offset), pageCount, beginSolve());
+            else if (what == "graph") graph->writeGraph(output, static_cast<size_t>(offset), pageCount);
+            else graph->writeMST(output, static_cast<size_t>(offset), pageCount, beginSolve());
+        } catch (const OperationCancelled& reason) {
+            replyCancelled(reason);
+        }
+        return Action::None;
+    }
+    if (command == "autoanalyze") {
+        int interval;
+        if (ss >> interval && interval >= 0) {
+            _autoAnalyzeInterval = interval;
+            _mutationsSinceAnalysis = 0;
+            if (interval == 0) out << "Automatic analysis disabled. Use 'analyze' to analyze the graph.\n";
+            else out << "Graph analyzed every " << interval << " change(s).\n";
+        } else {
+            out << "Invalid input. Syntax: 'autoanalyze <n>' with n >= 0\n";
+        }
+        return Action::None;
+    }
+    if (command == "deadline") {
+        long long milliseconds;
+        if (ss >> milliseconds && milliseconds >= 0) {
+            _solveTimeout = std::chrono::milliseconds(milliseconds);
+            if (milliseconds == 0) out << "Solve deadline disabled.\n";
+            else out << "MST solves stopped after " << milliseconds << " ms.\n";
+        } else {
+            out << "Invalid input. Syntax: 'deadline <ms>' with ms >= 0\n";
+        }
+        return Action::None;
+    }
+    if (command == "format") {
+        // L'acquittement est envoyé dans l'ancien format, les réponses suivantes dans le nouveau.
+        std::string format;
+        if (ss >> format && (format == "text" || format == "binary")) {
+            binary = format == "binary";
+            out << "Response format set to " << format << ".\n";
+        } else {
+            out << "Invalid input. Syntax: 'format <text|binary>'\n";
+        }
+        return Action::None;
+    }
+    if (command == "help") {
+        out << helpMenu();
+        return Action::None;
+    }
+    if (command == "shutdown") {
+        cancelComputations();
+        out << "Shutting down client.\n";
+        return Action::Close;
+    }
+    out << "Unknown command. Use 'help' for a list of commands.\n";
+    return Action::None;
+}
+
+// Envoie `output` directement depuis ses blocs (sendmsg peut n'en écrire qu'une partie), jusqu'à ce
+// qu'il soit vide ou que le socket, non bloquant, soit plein.
+bool Session::flush() {
+    _sendBlocked = false;
+    while (!output.empty()) {
+        struct iovec iov[16];
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = output.gather(iov, 16);
+        ssize_t n = sendmsg(_socket, &message, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            _sendBlocked = true; // La suite reste dans `output`.
+            return true;
+        }
+        if (n <= 0) {
+            output.clear();
+            return false;
+        }
+        output.consume(static_cast<size_t>(n));
+    }
+    return true;
+}
@@ -0,0 +1,260 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "SolveJobs.hpp"                    // Calculs lancés par `solve async`.
+#include "../../src/Model/Graph.hpp"        // Graphe manipulé par le client.
+#include "../../src/Model/OutputBuffer.hpp" // Tampon de sortie réutilisable.
+
+/**
+ * @class Session
+ * @brief État d'un client connecté : son graphe, ses réglages et ses tampons d'entrée/sortie.
+ *
+ * Les commandes sont délimitées par des fins de ligne : plusieurs commandes reçues dans un même
+ * `read` sont toutes exécutées, et une commande coupée entre deux lectures est complétée à la
+ * lecture suivante. Les réponses sont formatées directement dans `output` puis envoyées en une
+ * fois ; au-delà de OUTPUT_DRAIN_LIMIT octets, elles partent au fil de l'écriture. `show` permet de
+ * n'afficher qu'une page des arêtes du graphe ou de l'ACM ; si l'ACM doit d'abord être recalculé, la
+ * page est traitée comme une analyse (voir `Action::Analyze`).
+ *
+ * Les mutations (`create`, `add`, `remove`, `algo`) sont seulement acquittées. L'analyse est
+ * déclenchée par une commande `analyze` explicite, ou toutes les N mutations si la session a un
+ * intervalle d'analyse automatique (`autoanalyze <N>`, 0 = uniquement à la demande).
+ *
+ * Après `format binary`, chaque réponse est une trame `[u32 taille][u8 type][contenu]` (voir
+ * FrameType) : les textes deviennent des trames FRAME_TEXT, l'analyse une trame FRAME_ANALYSIS et
+ * `show` une trame FRAME_EDGES, sans aucun formatage de nombres.
+ *
+ * `solve async` lance le calcul de l'ACM et l'analyse d'une copie du graphe en arrière-plan (voir
+ * SolveJobs) et rend aussitôt un identifiant de travail, que `status`, `result` et `cancel` suivent.
+ * Un nouveau `solve async` remplace les travaux qui ne sont pas terminés : ils sont annulés.
+ *
+ * Les calculs d'ACM de la session (analyses et travaux) s'arrêtent au prochain point de contrôle du
+ * solveur lorsque la session est fermée (voir `cancelComputations`), ou lorsqu'ils dépassent le délai
+ * de la session (`deadline <ms>`, 0 = aucun).
+ */
+class Session {
+public:
+    /**
+     * @brief Ce que le serveur doit faire après l'exécution d'une commande.
+     */
+    enum class Action {
+        None,    ///< Rien de plus que la réponse déjà écrite dans `output`.
+        Analyze, ///< Analyser le graphe (sections `metrics`), ou écrire la page de `show mst` qui attend l'ACM, dans `output` (voir `writeAnalysis`).
+        Close    ///< Le client a demandé la fermeture de la session.
+    };
+
+    /**
+     * @brief Avancement d'une session après `resume`.
+     */
+    enum class Progress {
+        Idle,    ///< Aucune commande complète en attente : attendre de nouvelles données.
+        Pending, ///< Des commandes complètes restent à exécuter.
+        Analyze, ///< Une analyse trop coûteuse pour être faite sur place est due (voir `resume`).
+        Closed   ///< Le client a demandé la fermeture de la session.
+    };
+
+    std::unique_ptr<Graph> graph;     ///< Graphe du client (nul tant que `create` n'a pas été reçu).
+    unsigned metrics = ANALYSIS_ALL;  ///< Sections d'analyse demandées (voir AnalysisMetric).
+    OutputBuffer output;              ///< Réponses en attente d'envoi.
+    bool binary = false;              ///< Réponses encodées en trames binaires (`format binary`).
+
+    /// Taille à partir de laquelle `output` est envoyé au fil de l'écriture.
+    static constexpr size_t OUTPUT_DRAIN_LIMIT = 64 * 1024;
+    /// Longueur maximale d'une commande : au-delà, la session répond une erreur puis se ferme.
+    static constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+
+    /**
+     * @param socket Descripteur du socket client.
+     * @param autoAnalyzeInterval Nombre de mutations entre deux analyses automatiques (0 = à la demande).
+     */
+    explicit Session(int socket, int autoAnalyzeInterval = 1);
+
+    /// Annule les calculs encore en cours (voir `cancelComputations`).
+    ~Session();
+
+    int socket() const { return _socket; }
+
+    /**
+     * @brief Menu d'aide envoyé à la connexion d'un client.
+     */
+    static const std::string& helpMenu();
+
+    /**
+     * @brief Arrête les calculs d'ACM de la session, en cours ou à venir, et tous ses travaux : le
+     * client est parti, personne ne lira leur résultat. Définitif ; appelable depuis n'importe quel thread.
+     */
+    void cancelComputations() { _lifetime->cancel(); }
+
+    /**
+     * @brief Jeton du calcul d'ACM d'une analyse de la session, armé avec son délai (`deadline`).
+     *
+     * Pour les serveurs qui calculent l'analyse eux-mêmes ; `writeAnalysis` l'utilise déjà.
+     */
+    CancellationToken* beginSolve();
+
+    /**
+     * @brief Répond au client que l'analyse a été interrompue (délai dépassé ou session fermée).
+     */
+    void replyCancelled(const OperationCancelled& reason);
+
+    /**
+     * @brief Exécuteur des travaux `solve async` (le pool de calcul du serveur) ; sans exécuteur,
+     * ils sont faits sur place.
+     */
+    void setJobExecutor(SolveJobs::Executor executor) { _jobs.setExecutor(std::move(executor)); }
+
+    /**
+     * @brief Ajoute au tampon d'entrée des octets lus sur le socket.
+     *
+     * Si la commande en cours dépasse MAX_LINE_LENGTH sans fin de ligne, elle est abandonnée, ainsi
+     * que tout ce qui arrivera ensuite : une fois les commandes complètes précédentes exécutées, la
+     * session répond une erreur et se ferme (comme après `shutdown`).
+     * @return false si l'entrée a dépassé cette limite : inutile de lire davantage.
+     */
+    bool feed(const char* data, size_t size);
+
+    /**
+     * @brief Nombre d'octets reçus mais pas encore exécutés.
+     */
+    size_t pendingInput() const { return _input.size(); }
+
+    /**
+     * @brief Note que le client a fermé son côté de la connexion : plus aucun octet n'arrivera, mais
+     *        les commandes déjà reçues restent à exécuter et leurs réponses à envoyer.
+     */
+    void closeInput() { _inputClosed = true; }
+
+    bool inputClosed() const { return _inputClosed; }
+
+    /**
+     * @brief Extrait la prochaine commande complète du tampon d'entrée.
+     * @return false s'il n'y a pas encore de ligne complète.
+     */
+    bool nextCommand(std::string& command);
+
+    /**
+     * @brief Indique si le tampon d'entrée contient au moins une commande complète (ou une commande
+     *        trop longue, qui ferme la session).
+     */
+    bool hasCommand() const { return _inputOverflow || _input.find('\n') != std::string::npos; }
+
+    /**
+     * @brief Coût estimé de la prochaine commande complète, pour l'ordonnancement équitable.
+     *
+     * Une commande qui analyse le graphe (`analyze`, ou une mutation qui atteint l'intervalle
+     * d'analyse automatique) coûte de l'ordre de V + E si l'ACM doit être recalculé, V sinon ;
+     * `show` coûte le nombre d'arêtes affichables, plus le coût d'une analyse pour `show mst` si
+     * l'ACM doit être recalculé ; `solve async` (qui copie le graphe) coûte le nombre d'arêtes ;
+     * toutes les autres commandes coûtent 1.
+     */
+    uint64_t nextCommandCost() const;
+
+    /**
+     * @brief Coût estimé d'une analyse du graphe dans son état actuel (1 + V, plus E si l'ACM doit
+     * être recalculé).
+     */
+    uint64_t analysisCost() const;
+
+    /**
+     * @brief Abandonne les commandes complètes en attente et répond `reason` au client.
+     * @return Le nombre de commandes abandonnées.
+     */
+    size_t rejectPending(const std::string& reason);
+
+    /**
+     * @brief Exécute une commande et écrit la réponse dans `output`.
+     * @return L'action que le serveur doit effectuer ensuite.
+     */
+    Action execute(const std::string& command);
+
+    /**
+     * @brief Reprend l'exécution des commandes en attente, analyses comprises, dans la limite de `budget`.
+     *
+     * Permet de traiter une session par petites tâches : chaque appel reprend là où le précédent
+     * s'est arrêté, et les réponses s'accumulent dans `output`. Une analyse dont le coût dépasse
+     * `inlineAnalysisCost` n'est pas faite : `resume` renvoie `Progress::Analyze`, et c'est au serveur
+     * d'appeler `writeAnalysis` (sur un autre pool de threads) avant de reprendre.
+     */
+    Progress resume(int budget, uint64_t inlineAnalysisCost = UINT64_MAX);
+
+    /**
+     * @brief Écrit une réponse texte dans `output` (dans une trame FRAME_TEXT en mode binaire).
+     */
+    void reply(const std::string& text);
+
+    /**
+     * @brief Écrit l'analyse des sections `metrics` du graphe dans `output`, au format de la session.
+     *
+     * Si une page de `show mst` attend l'ACM (voir `pagePending`), c'est elle qui est écrite, une
+     * fois l'ACM recalculé. Si le calcul de l'ACM est interrompu, c'est l'erreur qui est écrite
+     * (voir `replyCancelled`).
+     */
+    void writeAnalysis();
+
+    /**
+     * @brief Indique si l'analyse due est une page de `show mst` : seul l'ACM est à calculer.
+     */
+    bool pagePending() const { return _pendingPage.has_value(); }
+
+    /**
+     * @brief Écrit une trame FRAME_ANALYSIS à partir de sections binaires déjà encodées.
+     * @param sections Masque des sections présentes (voir Graph::getAvailableSections).
+     * @param payload Sections concaténées dans l'ordre des bits (voir Graph::getBinarySection).
+     */
+    void writeAnalysisFrame(unsigned sections, const std::string& payload);
+
+    /**
+     * @brief Envoie le contenu de `output` sur le socket.
+     *
+     * Sur un socket bloquant, `output` est vidé. Sur un socket non bloquant, l'envoi s'arrête dès que
+     * le socket est plein : la suite reste dans `output`, les envois au fil de l'écriture sont
+     * suspendus, et le serveur reprend l'envoi lorsque le socket redevient inscriptible.
+     * @return false si l'envoi a échoué (`output` est alors vidé).
+     */
+    bool flush();
+
+    /**
+     * @brief Suspend (ou rétablit) les envois au fil de l'écriture : `output` ne fait alors que
+     *        grossir jusqu'au prochain `flush`. Pour écrire une réponse hors du thread qui sert la
+     *        session (analyse déportée), sans envoyer depuis ce thread.
+     */
+    void holdOutput(bool held) { _outputHeld = held; }
+
+private:
+    int _socket;
+    std::string _input;              ///< Octets reçus mais pas encore découpés en commandes.
+    int _autoAnalyzeInterval;        ///< Mutations entre deux analyses automatiques (0 = à la demande).
+    int _mutationsSinceAnalysis = 0; ///< Mutations depuis la dernière analyse.
+    OutputBuffer _reply;             ///< Réponse texte en cours, mise en trame en mode binaire.
+    bool _closed = false;            ///< `shutdown` reçu : plus aucune commande n'est exécutée.
+    bool _inputClosed = false;       ///< Voir `closeInput`.
+    bool _inputOverflow = false;     ///< Une commande a dépassé MAX_LINE_LENGTH (voir `feed`).
+    bool _sendBlocked = false;       ///< Le dernier `flush` s'est arrêté sur un socket plein.
+    bool _outputHeld = false;        ///< Voir `holdOutput`.
+    std::chrono::milliseconds _solveTimeout{0}; ///< Délai d'un calcul d'ACM (0 = aucun).
+    /// Annulé à la fermeture de la session ; parent de tous les jetons de la session.
+    std::shared_ptr<CancellationToken> _lifetime = std::make_shared<CancellationToken>();
+    CancellationToken _solve;        ///< Jeton des analyses (une seule à la fois).
+    SolveJobs _jobs;                 ///< Travaux lancés par `solve async`.
+
+    // Page de `show mst` demandée sur un ACM périmé : écrite par `writeAnalysis`.
+    struct Page {
+        size_t offset;
+        size_t count;
+    };
+    std::optional<Page> _pendingPage;
+
+    // Ajoute `_reply` à `output` dans une trame FRAME_TEXT (mode binaire).
+    void frameReply();
+    // Exécute la commande en écrivant sa réponse texte dans `out`.
+    Action dispatch(const std::string& request, OutputBuffer& out);
+    // Compte une mutation et indique si l'intervalle d'analyse automatique est atteint.
+    Action mutated();
+};
+
+#endif // SESSION_HPP
@@ -0,0 +1,101 @@
+#include "SolveJobs.hpp"
+#include "Logger.hpp"
+
+uint64_t SolveJobs::start(const Graph& graph, unsigned metrics, bool binary, std::chrono::milliseconds timeout) {
+    if (_jobs.size() >= MAX_JOBS) return 0;
+
+    auto job = std::make_shared<Job>(_parent);
+    job->graph = std::make_unique<Graph>(graph); // L'ACM déjà calculé, s'il est à jour, est copié avec.
+    job->metrics = metrics;
+    job->binary = binary;
+    job->timeout = timeout;
+    uint64_t cost = 1 + static_cast<uint64_t>(job->graph->getNumVertices()) + job->graph->getNumEdges();
+
+    uint64_t id = _nextId++;
+    _jobs.emplace(id, job);
+    if (!_executor) {
+        run(*job);
+    } else if (!_executor([job]() { run(*job); }, cost)) {
+        _jobs.erase(id);
+        return 0;
+    }
+    LOG_DEBUG("[SolveJobs] Job ", id, " started (cost ", cost, ").");
+    return id;
+}
+
+void SolveJobs::run(Job& job) {
+    try {
+        job.token.throwIfCancelled(); // Annulé avant même d'avoir commencé.
+        // Le délai ne compte pas l'attente de l'exécuteur.
+        if (job.timeout > std::chrono::milliseconds::zero()) {
+            job.token.setDeadline(CancellationToken::Clock::now() + job.timeout);
+        }
+        job.state.store(State::Solving, std::memory_order_release);
+        job.graph->Solve(&job.token);
+        job.token.clearDeadline(); // Le délai ne porte que sur le calcul de l'ACM.
+        job.token.throwIfCancelled();
+        job.state.store(State::Analyzing, std::memory_order_release);
+        if (job.binary) job.graph->writeAnalysisBinary(job.result, job.metrics);
+        else job.graph->writeAnalysis(job.result, job.metrics);
+        job.graph.reset();
+        // Annulé pendant l'analyse : le résultat ne sera pas lu.
+        job.state.store(job.token.isCancelled() ? State::Cancelled : State::Done, std::memory_order_release);
+    } catch (const DeadlineExceeded& e) {
+        job.graph.reset();
+        job.error = e.what();
+        job.state.store(State::Failed, std::memory_order_release);
+    } catch (const OperationCancelled&) {
+        job.graph.reset();
+        job.state.store(State::Cancelled, std::memory_order_release);
+    } catch (const std::exception& e) {
+        job.graph.reset();
+        job.error = e.what();
+        job.state.store(State::Failed, std::memory_order_release);
+    }
+}
+
+bool SolveJobs::status(uint64_t id, Status& status) const {
+    auto it = _jobs.find(id);
+    if (it == _jobs.end()) return false;
+    const Job& job = *it->second;
+    status.state = job.state.load(std::memory_order_acquire);
+    // Annulé mais pas encore arrêté : il ne produira de toute façon pas de résultat.
+    if (!finished(status.state) && job.token.isCancelled()) status.state = State::Cancelled;
+    status.progress = job.token.progress();
+    status.binary = job.binary;
+    status.error = status.state == State::Failed ? job.error : std::string();
+    return true;
+}
+
+bool SolveJobs::takeResult(uint64_t id, OutputBuffer& out) {
+    auto it = _jobs.find(id);
+    if (it == _jobs.end() || it->second->state.load(std::memory_order_acquire) != State::Done) return false;
+    out.append(it->second->result);
+    _jobs.erase(it);
+    return true;
+}
+
+bool SolveJobs::cancel(uint64_t id) {
+    auto it = _jobs.find(id);
+    if (it == _jobs.end()) return false;
+    // La tâche de l'exécuteur garde le travail jusqu'à son arrêt ; la place est libérée tout de suite.
+    it->second->token.cancel();
+    _jobs.erase(it);
+    return true;
+}
+
+size_t SolveJobs::cancelUnfinished() {
+    size_t cancelled = 0;
+    for (auto it = _jobs.begin(); it != _jobs.end();) {
+        Job& job = *it->second;
+        if (finished(job.state.load(std::memory_order_acquire))) {
+            ++it;
+            continue;
+        }
+        // Comme pour `cancel`, la place est libérée sans attendre l'arrêt du calcul.
+        if (!job.token.isCancelled()) ++cancelled;
+        job.token.cancel();
+        it = _jobs.erase(it);
+    }
+    return cancelled;
+}
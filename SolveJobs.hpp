@@ -0,0 +1,131 @@
+#ifndef SOLVE_JOBS_HPP
+#define SOLVE_JOBS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include "UniqueTask.hpp"                     // Tâche exécutée en arrière-plan.
+#include "../../src/Model/Cancellation.hpp"   // Annulation et progression du solveur.
+#include "../../src/Model/Graph.hpp"          // Copie du graphe analysée par un travail.
+#include "../../src/Model/OutputBuffer.hpp"   // Analyse produite par un travail.
+
+/**
+ * @class SolveJobs
+ * @brief Calculs d'ACM et analyses lancés en arrière-plan par une session (`solve async`).
+ *
+ * Un travail porte sur une copie du graphe prise à son lancement : pendant le calcul, la session
+ * peut continuer à modifier son graphe, ou en créer un autre et lancer un autre travail. Le calcul
+ * s'exécute sur le pool de calcul du serveur (voir `Executor`) ; sans exécuteur, il est fait sur
+ * place. Chaque travail a un identifiant propre à la session : `status` donne son état et sa
+ * progression, `takeResult` rend l'analyse (au format de réponse choisi à son lancement) puis oublie
+ * le travail, et `cancel` l'interrompt au prochain point de contrôle du solveur et l'oublie aussitôt.
+ *
+ * Le jeton de chaque travail est l'enfant du jeton de la session (voir Session::cancelComputations) :
+ * tous ses travaux s'arrêtent lorsqu'elle est fermée. Un délai de calcul, compté à partir du début
+ * du calcul, fait échouer un travail dont l'ACM n'est pas calculé à temps. Un travail annulé ne
+ * produit jamais de résultat, même si son calcul était déjà terminé.
+ *
+ * Utilisée par le seul thread qui sert la session ; seul l'état d'un travail est partagé avec le
+ * thread qui l'exécute.
+ */
+class SolveJobs {
+public:
+    /// Lance une tâche en arrière-plan, de coût estimé donné ; false si elle n'a pas pu être lancée.
+    using Executor = std::function<bool(UniqueTask task, uint64_t cost)>;
+
+    /// Nombre maximal de travaux lancés et pas encore récupérés, par session.
+    static constexpr size_t MAX_JOBS = 16;
+
+    enum class State { Queued, Solving, Analyzing, Done, Cancelled, Failed };
+
+    /**
+     * @brief État d'un travail, tel que rapporté par `status`.
+     */
+    struct Status {
+        State state = State::Queued;
+        double progress = 0.0; ///< Avancement du calcul de l'ACM, dans [0, 1].
+        bool binary = false;   ///< Format de réponse de l'analyse.
+        std::string error;     ///< Cause de l'échec (State::Failed).
+    };
+
+    /**
+     * @param parent Jeton dont l'annulation arrête tous les travaux (aucun si nul).
+     */
+    explicit SolveJobs(std::shared_ptr<const CancellationToken> parent = nullptr) : _parent(std::move(parent)) {}
+
+    void setExecutor(Executor executor) { _executor = std::move(executor); }
+
+    /**
+     * @brief Nombre de travaux lancés et pas encore récupérés.
+     */
+    size_t size() const { return _jobs.size(); }
+
+    /**
+     * @brief Lance l'analyse des sections `metrics` d'une copie de `graph`.
+     * @param timeout Délai du calcul de l'ACM (0 : aucun).
+     * @return L'identifiant du travail, ou 0 si MAX_JOBS travaux sont déjà en cours ou si
+     *         l'exécuteur a refusé la tâche.
+     */
+    uint64_t start(const Graph& graph, unsigned metrics, bool binary,
+                   std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    /**
+     * @return false si le travail `id` est inconnu.
+     */
+    bool status(uint64_t id, Status& status) const;
+
+    /**
+     * @brief Ajoute l'analyse du travail `id`, s'il est terminé, à `out`, puis l'oublie.
+     * @return false si le travail est inconnu ou n'est pas terminé (rien n'est écrit).
+     */
+    bool takeResult(uint64_t id, OutputBuffer& out);
+
+    /**
+     * @brief Demande l'arrêt du travail `id` et l'oublie : sa place est libre pour un nouveau travail,
+     *        même si son calcul ne s'arrête qu'au prochain point de contrôle.
+     * @return false si le travail est inconnu.
+     */
+    bool cancel(uint64_t id);
+
+    /**
+     * @brief Annule et oublie les travaux qui ne sont pas encore terminés (remplacés par un nouveau
+     *        travail) ; seuls les travaux terminés et pas encore récupérés gardent leur place.
+     * @return Le nombre de travaux annulés.
+     */
+    size_t cancelUnfinished();
+
+    /**
+     * @brief Oublie le travail `id` (son calcul, s'il tourne encore, se termine sans effet).
+     */
+    void forget(uint64_t id) { _jobs.erase(id); }
+
+private:
+    struct Job {
+        explicit Job(std::shared_ptr<const CancellationToken> parent) : token(std::move(parent)) {}
+
+        CancellationToken token;
+        std::atomic<State> state{State::Queued};
+        std::unique_ptr<Graph> graph; ///< Copie analysée, libérée dès la fin du calcul.
+        unsigned metrics = 0;
+        bool binary = false;
+        std::chrono::milliseconds timeout{0};
+        OutputBuffer result;          ///< Analyse, complète lorsque l'état passe à Done.
+        std::string error;            ///< Écrit avant que l'état passe à Failed.
+    };
+
+    std::shared_ptr<const CancellationToken> _parent;
+    std::map<uint64_t, std::shared_ptr<Job>> _jobs;
+    uint64_t _nextId = 1;
+    Executor _executor;
+
+    // Calcule l'ACM de la copie puis son analyse (sur le thread de l'exécuteur).
+    static void run(Job& job);
+    // Un travail dans cet état ne changera plus d'état.
+    static bool finished(State state) { return state == State::Done || state == State::Cancelled || state == State::Failed; }
+};
+
+#endif // SOLVE_JOBS_HPP
@@ -0,0 +1,170 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>               // Pour les indices partagés entre producteur et consommateur
+#include <condition_variable>   // Pour endormir un thread qui a fini d'attendre activement
+#include <cstddef>              // Pour size_t
+#include <memory>               // Pour std::unique_ptr (tableau des cases)
+#include <mutex>                // Pour le verrou associé à la condition
+#include <thread>               // Pour std::this_thread::yield et hardware_concurrency
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>          // Pour _mm_pause pendant l'attente active
+#endif
+
+/**
+ * @class SpscRing
+ * @brief File circulaire bornée sans verrou, pour exactement un producteur et un consommateur.
+ *
+ * Seul le producteur écrit `_tail` et seul le consommateur écrit `_head` ; chacun garde une copie
+ * locale de l'indice de l'autre et ne relit l'indice partagé que lorsque cette copie ne suffit
+ * plus. Les deux indices sont sur des lignes de cache distinctes : producteur et consommateur ne
+ * se disputent une ligne que lorsque la file passe de vide à non vide (ou de pleine à non pleine).
+ *
+ * La capacité est arrondie à la puissance de deux supérieure.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        _mask = size - 1;
+        _slots = std::make_unique<T[]>(size);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Ajoute `item` (producteur uniquement).
+     * @return false si la file est pleine ; `item` n'est alors pas déplacé.
+     */
+    bool try_push(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead > _mask) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead > _mask) return false;
+        }
+        _slots[tail & _mask] = std::move(item);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Retire l'élément le plus ancien dans `item` (consommateur uniquement).
+     * @return false si la file est vide.
+     */
+    bool try_pop(T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail) return false;
+        }
+        item = std::move(_slots[head & _mask]);
+        _slots[head & _mask] = T(); // Libère aussitôt ce que la case retenait encore.
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    // Nombre d'éléments présents (approximatif si l'autre côté travaille en même temps).
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<size_t> _head{0}; // Prochaine case à lire (écrit par le consommateur)
+    size_t _cachedTail = 0;                           // Dernier `_tail` lu par le consommateur
+    alignas(CACHE_LINE) std::atomic<size_t> _tail{0}; // Prochaine case à écrire (écrit par le producteur)
+    size_t _cachedHead = 0;                           // Dernier `_head` lu par le producteur
+    alignas(CACHE_LINE) size_t _mask = 0;
+    std::unique_ptr<T[]> _slots;
+};
+
+/**
+ * @class SpinThenPark
+ * @brief Attente adaptative d'une condition : attente active, puis `yield`, puis sommeil.
+ *
+ * Le nombre d'itérations d'attente active s'adapte : il double lorsque la condition est devenue
+ * vraie pendant l'attente active, et diminue de moitié lorsque le thread a dû s'endormir. Sur une
+ * machine à un seul cœur, l'attente active est désactivée (elle ne ferait que retarder l'autre
+ * thread). `notify` ne prend le verrou que si un thread dort réellement.
+ */
+class SpinThenPark {
+public:
+    SpinThenPark() : _spinLimit(std::thread::hardware_concurrency() > 1 ? INITIAL_SPINS : 0) {}
+
+    /**
+     * @brief Attend que `ready()` soit vrai. `ready` doit lire l'état partagé de façon atomique.
+     */
+    template <typename Ready>
+    void wait(Ready ready) {
+        int limit = _spinLimit.load(std::memory_order_relaxed);
+        for (int i = 0; i < limit; ++i) {
+            if (ready()) {
+                if (limit < MAX_SPINS) _spinLimit.store(limit * 2, std::memory_order_relaxed);
+                return;
+            }
+            relax();
+        }
+        for (int i = 0; i < YIELDS; ++i) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+
+        if (limit > MIN_SPINS) _spinLimit.store(limit / 2, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _parked.store(true, std::memory_order_relaxed);
+        // Avec la barrière de `notify` : soit l'autre thread voit `_parked`, soit `ready()` voit son écriture.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        _cv.wait(lock, ready);
+        _parked.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Réveille le thread endormi dans `wait`, s'il y en a un. À appeler après avoir rendu
+     * la condition vraie.
+     */
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_parked.load(std::memory_order_relaxed)) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cv.notify_all();
+    }
+
+    /**
+     * @brief Réveille le thread endormi sans condition (par exemple lors d'un arrêt).
+     */
+    void notify_always() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cv.notify_all();
+    }
+
+private:
+    static constexpr int INITIAL_SPINS = 256;
+    static constexpr int MIN_SPINS = 16;
+    static constexpr int MAX_SPINS = 16384;
+    static constexpr int YIELDS = 4;
+
+    std::atomic<int>        _spinLimit;
+    std::atomic<bool>       _parked{false};
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+
+    static void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+};
+
+#endif // SPSC_RING_HPP
@@ -0,0 +1,59 @@
+#ifndef TASK_QUEUE_HPP
+#define TASK_QUEUE_HPP
+
+#include <cstddef>  // Pour size_t
+#include <utility>  // Pour std::move
+#include <vector>   // Pour le tableau circulaire
+
+/**
+ * @class TaskQueue
+ * @brief File FIFO sur un tableau circulaire qui double lorsqu'il est plein et ne rétrécit jamais.
+ *
+ * Contrairement à `std::deque`, qui alloue et libère un bloc toutes les quelques tâches lorsque la
+ * file avance, une fois sa taille de croisière atteinte elle n'alloue plus rien. Non synchronisée :
+ * elle est protégée par le verrou de son propriétaire.
+ */
+template <typename T>
+class TaskQueue {
+public:
+    explicit TaskQueue(size_t capacity = 16) : _slots(capacity > 0 ? capacity : 1) {}
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    void push(T item) {
+        if (_size == _slots.size()) grow();
+        _slots[(_head + _size) % _slots.size()] = std::move(item);
+        ++_size;
+    }
+
+    // Élément le plus ancien, sans le retirer ; la file ne doit pas être vide.
+    T& front() { return _slots[_head]; }
+
+    // Retire et renvoie l'élément le plus ancien ; la file ne doit pas être vide.
+    T pop() {
+        T item = std::move(_slots[_head]);
+        _slots[_head] = T(); // Libère aussitôt ce que la case retenait encore.
+        _head = (_head + 1) % _slots.size();
+        --_size;
+        return item;
+    }
+
+    void clear() {
+        while (!empty()) pop();
+    }
+
+private:
+    std::vector<T> _slots;
+    size_t _head = 0;
+    size_t _size = 0;
+
+    void grow() {
+        std::vector<T> bigger(2 * _slots.size());
+        for (size_t i = 0; i < _size; ++i) bigger[i] = std::move(_slots[(_head + i) % _slots.size()]);
+        _slots = std::move(bigger);
+        _head = 0;
+    }
+};
+
+#endif // TASK_QUEUE_HPP
@@ -0,0 +1,115 @@
+#ifndef UNIQUE_TASK_HPP
+#define UNIQUE_TASK_HPP
+
+#include <cstddef>      // Pour std::max_align_t et std::nullptr_t
+#include <new>          // Pour le placement new
+#include <type_traits>  // Pour choisir entre stockage interne et tas
+#include <utility>      // Pour std::move et std::forward
+
+/**
+ * @class UniqueTask
+ * @brief Tâche `void()` non copiable, avec un tampon interne pour les petites captures.
+ *
+ * Remplace `std::function<void()>` dans les files de tâches : une lambda dont les captures tiennent
+ * dans `INLINE_SIZE` octets (toutes celles des serveurs : `this`, un descripteur, un pointeur
+ * partagé...) est rangée dans l'objet lui-même, si bien que soumettre une tâche n'alloue rien. Les
+ * captures plus grandes passent sur le tas. Contrairement à `std::function`, les fonctions non
+ * copiables (qui capturent un `std::unique_ptr`, une `std::promise`...) sont acceptées.
+ */
+class UniqueTask {
+public:
+    static constexpr size_t INLINE_SIZE = 48; ///< Taille maximale d'une capture stockée sans allocation.
+
+    UniqueTask() noexcept = default;
+    UniqueTask(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, UniqueTask>::value>>
+    UniqueTask(F&& function) {
+        using Function = std::decay_t<F>;
+        if constexpr (fitsInline<Function>()) {
+            new (_storage) Function(std::forward<F>(function));
+            _vtable = &inlineVTable<Function>;
+        } else {
+            *reinterpret_cast<Function**>(_storage) = new Function(std::forward<F>(function));
+            _vtable = &heapVTable<Function>;
+        }
+    }
+
+    UniqueTask(UniqueTask&& other) noexcept {
+        moveFrom(other);
+    }
+
+    UniqueTask& operator=(UniqueTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    UniqueTask& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    UniqueTask(const UniqueTask&) = delete;
+    UniqueTask& operator=(const UniqueTask&) = delete;
+
+    ~UniqueTask() { reset(); }
+
+    explicit operator bool() const noexcept { return _vtable != nullptr; }
+
+    void operator()() { _vtable->invoke(_storage); }
+
+private:
+    // Opérations sur la fonction stockée, propres à son type.
+    struct VTable {
+        void (*invoke)(void* storage);
+        void (*move)(void* destination, void* source) noexcept; // Déplace puis détruit la source.
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Function>
+    static constexpr bool fitsInline() {
+        return sizeof(Function) <= INLINE_SIZE && alignof(Function) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Function>::value;
+    }
+
+    template <typename Function>
+    static constexpr VTable inlineVTable = {
+        [](void* storage) { (*static_cast<Function*>(storage))(); },
+        [](void* destination, void* source) noexcept {
+            new (destination) Function(std::move(*static_cast<Function*>(source)));
+            static_cast<Function*>(source)->~Function();
+        },
+        [](void* storage) noexcept { static_cast<Function*>(storage)->~Function(); },
+    };
+
+    template <typename Function>
+    static constexpr VTable heapVTable = {
+        [](void* storage) { (**static_cast<Function**>(storage))(); },
+        [](void* destination, void* source) noexcept {
+            *static_cast<Function**>(destination) = *static_cast<Function**>(source);
+        },
+        [](void* storage) noexcept { delete *static_cast<Function**>(storage); },
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[INLINE_SIZE];
+    const VTable* _vtable = nullptr;
+
+    void moveFrom(UniqueTask& other) noexcept {
+        if (!other._vtable) return;
+        other._vtable->move(_storage, other._storage);
+        _vtable = other._vtable;
+        other._vtable = nullptr;
+    }
+
+    void reset() noexcept {
+        if (_vtable) {
+            _vtable->destroy(_storage);
+            _vtable = nullptr;
+        }
+    }
+};
+
+#endif // UNIQUE_TASK_HPP
@@ -0,0 +1,83 @@
+#include "WorkerPool.hpp"
+#include "Logger.hpp"
+
+WorkerPool::WorkerPool(int num_threads, size_t max_pending, const CpuSet& cpus) : _max_pending(max_pending), _running(true) {
+    for (int i = 0; i < num_threads; ++i) {
+        _threads.emplace_back(&WorkerPool::worker_loop, this);
+        size_t index = static_cast<size_t>(i);
+        if (index < cpus.size() && !pinThread(_threads.back(), cpus[index])) {
+            LOG_WARNING("[WorkerPool] Failed to pin thread ", i, " to CPU ", cpus[index], ".");
+        }
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+namespace {
+constexpr int NO_CLIENT = -1; // Client des tâches soumises sans client
+}
+
+bool WorkerPool::try_submit(Task task) {
+    return try_submit(NO_CLIENT, 1, std::move(task));
+}
+
+bool WorkerPool::try_submit(int client, uint64_t cost, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running || _tasks.size() >= _max_pending) return false; // Pool saturé : admission refusée.
+        _tasks.push(client, std::move(task), cost);
+    }
+    _cv.notify_one();
+    return true;
+}
+
+bool WorkerPool::submit(int client, uint64_t cost, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) return false;
+        _tasks.push(client, std::move(task), cost);
+    }
+    _cv.notify_one();
+    return true;
+}
+
+void WorkerPool::forget(int client) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.forget(client);
+}
+
+size_t WorkerPool::pending() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tasks.size();
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+        _tasks.clear();
+    }
+    _cv.notify_all();
+    for (auto& thread : _threads) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void WorkerPool::worker_loop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]() { return !_running || !_tasks.empty(); });
+            if (!_running) return;
+            task = _tasks.pop();
+        }
+        try {
+            task();
+        } catch (const std::exception& e) { // Une tâche en échec ne doit pas arrêter le thread.
+            LOG_ERROR("[WorkerPool] Task exception: ", e.what());
+        }
+    }
+}
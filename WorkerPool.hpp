@@ -0,0 +1,89 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <vector>               // Pour std::vector pour gérer les threads
+#include <cstdint>              // Pour le coût des tâches
+#include "FairQueue.hpp"        // Pour la file des tâches, équitable entre clients
+#include <thread>               // Pour std::thread pour gérer les threads
+#include <mutex>                // Pour std::mutex pour la synchronisation
+#include <condition_variable>   // Pour std::condition_variable pour réveiller les threads
+#include "UniqueTask.hpp"       // Pour représenter les tâches sans allocation
+#include "CpuAffinity.hpp"      // Pour fixer les threads sur des cœurs
+
+/**
+ * @class WorkerPool
+ * @brief Pool de threads de taille fixe avec une file de tâches bornée.
+ *
+ * Les threads sont créés une fois pour toutes et partagés par tous les clients. La file d'attente
+ * est bornée : lorsque `max_pending` tâches attendent déjà, `try_submit` refuse la tâche au lieu de
+ * laisser la file (et la latence) croître sans limite. C'est à l'appelant de signaler le refus au
+ * client (contrôle d'admission).
+ *
+ * Les tâches ne sont pas servies dans l'ordre d'arrivée mais à tour de rôle entre clients, selon
+ * leur coût estimé (voir FairQueue) : un client qui sature le pool de lourdes analyses ne retarde
+ * les autres que d'une part des threads.
+ */
+class WorkerPool {
+public:
+    using Task=UniqueTask; // Alias pour représenter une tâche : une fonction sans argument ni retour, non copiable.
+
+    /**
+     * @param num_threads Nombre de threads du pool.
+     * @param max_pending Nombre maximal de tâches en attente (hors tâches en cours d'exécution).
+     * @param cpus Cœur de chaque thread, dans l'ordre (vide : threads non fixés).
+     */
+    WorkerPool(int num_threads, size_t max_pending, const CpuSet& cpus = {});
+
+    /**
+     * @brief Destructeur : arrête le pool et attend la fin des threads.
+     */
+    ~WorkerPool();
+
+    /**
+     * @brief Ajoute une tâche sans client (servie comme un client à part) si la file n'est pas pleine.
+     * @return false si la file est pleine ou le pool arrêté : la tâche n'est pas exécutée.
+     */
+    bool try_submit(Task task);
+
+    /**
+     * @brief Ajoute une tâche de `client`, de coût estimé `cost`, si la file n'est pas pleine.
+     * @return false si la file est pleine ou le pool arrêté : la tâche n'est pas exécutée.
+     */
+    bool try_submit(int client, uint64_t cost, Task task);
+
+    /**
+     * @brief Ajoute la suite d'une tâche déjà admise de `client`, même si la file est pleine.
+     * @return false si le pool est arrêté.
+     */
+    bool submit(int client, uint64_t cost, Task task);
+
+    /**
+     * @brief Oublie `client` (déconnecté) une fois ses tâches en attente exécutées.
+     */
+    void forget(int client);
+
+    /**
+     * @brief Nombre de tâches en attente d'un thread.
+     */
+    size_t pending();
+
+    /**
+     * @brief Arrête le pool : les tâches en attente sont abandonnées, celles en cours terminées.
+     */
+    void stop();
+
+private:
+    FairQueue<int, Task>     _tasks;       // Tâches en attente, par client
+    size_t                   _max_pending; // Capacité de la file
+    std::vector<std::thread> _threads;     // Threads du pool
+    std::mutex               _mutex;       // Protège la file et `_running`
+    std::condition_variable  _cv;          // Réveille un thread lorsqu'une tâche arrive
+    bool                     _running;     // Indique si le pool accepte et exécute des tâches
+
+    /**
+     * @brief Boucle de chaque thread : attend une tâche, l'exécute, recommence.
+     */
+    void worker_loop();
+};
+
+#endif // WORKERPOOL_HPP
@@ -1,33 +1,75 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
+#include "../src/Network/CpuAffinity.hpp"
 #include "../src/Network/Server.hpp"
 #include "../src/Network/Server_LF.hpp"
 #include "../src/Network/Server_PL.hpp"
+#include "../src/Network/Server_RE.hpp"
 
 int main(int argc, char* argv[]) {
+    // Sépare les options (--pin, --pin=<cœurs>, --max-threads=<n>, --compute-threads=<n>) des arguments positionnels
+    std::vector<std::string> args;
+    CpuPlacement placement;      // Threads non fixés par défaut
+    int max_threads = 0;         // Pool LF de taille fixe par défaut
+    int compute_threads = -1;    // Pool de calcul (LF et RE) : autant de threads que le pool principal par défaut
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--pin") {
+            placement = CpuPlacement::topologyDefault();
+        } else if (arg.compare(0, 6, "--pin=") == 0) {
+            try {
+                placement = CpuPlacement(parseCpuList(arg.substr(6)));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (arg.compare(0, 14, "--max-threads=") == 0) {
+            try {
+                max_threads = std::stoi(arg.substr(14));
+            } catch (...) {
+                std::cerr << "Error: Invalid maximum number of threads." << std::endl;
+                return 1;
+            }
+        } else if (arg.compare(0, 18, "--compute-threads=") == 0) {
+            try {
+                compute_threads = std::stoi(arg.substr(18));
+            } catch (...) {
+                std::cerr << "Error: Invalid number of compute threads." << std::endl;
+                return 1;
+            }
+            if (compute_threads < 0) {
+                std::cerr << "Error: Number of compute threads must be at least 0." << std::endl;
+                return 1;
+            }
+        } else {
+            args.push_back(arg);
+        }
+    }
+
     // Vérifiez les arguments fournis par l'utilisateur
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " -PL|-LF [<num_threads>] [<port>]" << std::endl;
+    if (args.empty()) {
+        std::cerr << "Usage: " << argv[0] << " -PL|-LF|-RE [<num_threads>] [<port>] [--pin[=<cpus>]] [--max-threads=<n>] [--compute-threads=<n>]" << std::endl;
         return 1;
     }
 
-    std::string mode = argv[1];   // Mode choisi : -PL ou -LF
+    std::string mode = args[0];  // Mode choisi : -PL, -LF ou -RE
     int num_threads = 4;         // Nombre de threads par défaut
     int port = 8080;             // Port par défaut
 
     // Lire le nombre de threads et le port, si fournis
-    if (argc >= 3) {
+    if (args.size() >= 2) {
         try {
-            num_threads = std::stoi(argv[2]);
+            num_threads = std::stoi(args[1]);
         } catch (...) {
             std::cerr << "Error: Invalid number of threads." << std::endl;
             return 1;
         }
     }
-    if (argc >= 4) {
+    if (args.size() >= 3) {
         try {
-            port = std::stoi(argv[3]);
+            port = std::stoi(args[2]);
         } catch (...) {
             std::cerr << "Error: Invalid port number." << std::endl;
             return 1;
@@ -39,6 +81,11 @@ int main(int argc, char* argv[]) {
         std::cerr << "Error: Number of threads must be greater than 0." << std::endl;
         return 1;
     }
+    if (compute_threads < 0) compute_threads = num_threads;
+    if (max_threads != 0 && max_threads < num_threads) {
+        std::cerr << "Error: Maximum number of threads must be at least the number of threads." << std::endl;
+        return 1;
+    }
     if (port <= 0 || port > 65535) {
         std::cerr << "Error: Port must be between 1 and 65535." << std::endl;
         return 1;
@@ -51,11 +98,18 @@ int main(int argc, char* argv[]) {
         // Instanciez le serveur en fonction du mode choisi
         if (mode == "-LF") {
             std::cout << "Starting Leader-Followers server on port " << port
-                      << " with " << num_threads << " threads..." << std::endl;
-            server = std::make_unique<Server_LF>("127.0.0.1", port, num_threads);
+                      << " with " << num_threads << (max_threads > num_threads ? " to " + std::to_string(max_threads) : "")
+                      << " threads and " << compute_threads << " compute threads..." << std::endl;
+            server = std::make_unique<Server_LF>("127.0.0.1", port, num_threads, placement, max_threads, compute_threads);
         } else if (mode == "-PL") {
-            std::cout << "Starting Pipeline server on port " << port << "..." << std::endl;
-            server = std::make_unique<Server_PL>("127.0.0.1", port); // Supprime num_threads
+            std::cout << "Starting Pipeline server on port " << port
+                      << " with " << num_threads << " worker threads..." << std::endl;
+            server = std::make_unique<Server_PL>("127.0.0.1", port, num_threads, placement);
+        } else if (mode == "-RE") {
+            std::cout << "Starting Reactor server on port " << port
+                      << " with " << num_threads << " worker threads and " << compute_threads << " compute threads..." << std::endl;
+            server = std::make_unique<Server_RE>("127.0.0.1", port, num_threads, Server_RE::DEFAULT_MAX_CLIENTS, placement,
+                                                 compute_threads);
         } else {
             std::cerr << "Unknown mode: " << mode << std::endl;
             return 1;
@@ -65,6 +119,7 @@ int main(int argc, char* argv[]) {
         server->start();
 
         // Rester actif jusqu'à ce que l'utilisateur appuie sur Entrée
+        flushLogs(); // Les journaux du démarrage s'affichent avant l'invite.
         std::cout << "Press Enter to stop the server..." << std::endl;
         std::cin.get();
 